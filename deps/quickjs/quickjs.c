@@ -12071,6 +12071,32 @@ JSValue JS_NewBigUint64(JSContext *ctx, uint64_t v)
     return val;
 }
 
+/* return the BigInt hi * 2^64 + lo */
+JSValue JS_NewBigUint128(JSContext *ctx, uint64_t lo, uint64_t hi)
+{
+    JSValue val;
+    bf_t *a, b_s, *b = &b_s;
+    int ret;
+
+    if (hi == 0)
+        return JS_NewBigUint64(ctx, lo);
+    val = JS_NewBigInt(ctx);
+    if (JS_IsException(val))
+        return val;
+    a = JS_GetBigInt(val);
+    bf_init(ctx->bf_ctx, b);
+    ret = bf_set_ui(a, hi);
+    ret |= bf_mul_2exp(a, 64, BF_PREC_INF, BF_RNDZ);
+    ret |= bf_set_ui(b, lo);
+    ret |= bf_add(a, a, b, BF_PREC_INF, BF_RNDZ);
+    bf_delete(b);
+    if (ret) {
+        JS_FreeValue(ctx, val);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    return val;
+}
+
 /* return NaN if bad bigint literal */
 static JSValue JS_StringToBigInt(JSContext *ctx, JSValue val)
 {
@@ -28461,6 +28487,35 @@ JSValue JS_LoadModule(JSContext *ctx, const char *basename,
     return promise;
 }
 
+/* Load, link and evaluate a module synchronously. Return NULL with a
+   pending exception if it cannot be loaded or if its evaluation throws. A
+   module using top-level await may not be fully evaluated on return. */
+JSModuleDef *JS_RunModule(JSContext *ctx, const char *basename,
+                          const char *filename)
+{
+    JSModuleDef *m;
+    JSValue ret, func_obj;
+
+    m = js_host_resolve_imported_module(ctx, basename, filename);
+    if (!m)
+        return NULL;
+    if (js_resolve_module(ctx, m) < 0) {
+        js_free_modules(ctx, JS_FREE_MODULE_NOT_RESOLVED);
+        return NULL;
+    }
+    func_obj = JS_NewModuleValue(ctx, m);
+    ret = JS_EvalFunction(ctx, func_obj);
+    if (JS_IsException(ret))
+        return NULL;
+    if (JS_PromiseState(ctx, ret) == JS_PROMISE_REJECTED) {
+        JS_Throw(ctx, JS_PromiseResult(ctx, ret));
+        JS_FreeValue(ctx, ret);
+        return NULL;
+    }
+    JS_FreeValue(ctx, ret);
+    return m;
+}
+
 static JSValue js_dynamic_import_job(JSContext *ctx,
                                      int argc, JSValueConst *argv)
 {
@@ -28926,6 +28981,29 @@ static JSValue js_evaluate_module(JSContext *ctx, JSModuleDef *m)
     return JS_DupValue(ctx, m->promise);
 }
 
+/* Link and evaluate the module 'm' if needed, then return its namespace
+   object. Only synchronous (e.g. C) modules are supported: no parsing and
+   no pending job is involved. */
+JSValue JS_GetModuleNamespace(JSContext *ctx, JSModuleDef *m)
+{
+    JSValue promise, error;
+
+    if (js_create_module_function(ctx, m) < 0)
+        return JS_EXCEPTION;
+    if (js_link_module(ctx, m) < 0)
+        return JS_EXCEPTION;
+    promise = js_evaluate_module(ctx, m);
+    if (JS_IsException(promise))
+        return JS_EXCEPTION;
+    if (JS_PromiseState(ctx, promise) == JS_PROMISE_REJECTED) {
+        error = JS_PromiseResult(ctx, promise);
+        JS_FreeValue(ctx, promise);
+        return JS_Throw(ctx, error);
+    }
+    JS_FreeValue(ctx, promise);
+    return js_get_module_ns(ctx, m);
+}
+
 static __exception JSAtom js_parse_from_clause(JSParseState *s)
 {
     JSAtom module_name;
@@ -35460,6 +35538,7 @@ typedef struct BCReaderState {
     BOOL allow_sab : 8;
     BOOL allow_bytecode : 8;
     BOOL is_rom_data : 8;
+    BOOL is_in_place : 8;
     BOOL allow_reference : 8;
     /* object references */
     JSObject **objects;
@@ -35715,7 +35794,7 @@ static int JS_ReadFunctionBytecode(BCReaderState *s, JSFunctionBytecode *b,
         case OP_FMT_atom_label_u8:
         case OP_FMT_atom_label_u16:
             idx = get_u32(bc_buf + pos + 1);
-            if (s->is_rom_data) {
+            if (s->is_rom_data && !s->is_in_place) {
                 /* just increment the reference count of the atom */
                 JS_DupAtom(s->ctx, (JSAtom)idx);
             } else {
@@ -36565,7 +36644,7 @@ static int JS_ReadObjectAtoms(BCReaderState *s)
         if (atom == JS_ATOM_NULL)
             return s->error_state = -1;
         s->idx_to_atom[i] = atom;
-        if (s->is_rom_data && (atom != (i + s->first_atom)))
+        if (s->is_rom_data && !s->is_in_place && (atom != (i + s->first_atom)))
             s->is_rom_data = FALSE; /* atoms must be relocated */
     }
     bc_read_trace(s, "}\n");
@@ -36599,7 +36678,8 @@ JSValue JS_ReadObject(JSContext *ctx, const uint8_t *buf, size_t buf_len,
     s->buf_end = buf + buf_len;
     s->ptr = buf;
     s->allow_bytecode = ((flags & JS_READ_OBJ_BYTECODE) != 0);
-    s->is_rom_data = ((flags & JS_READ_OBJ_ROM_DATA) != 0);
+    s->is_rom_data = ((flags & (JS_READ_OBJ_ROM_DATA | JS_READ_OBJ_IN_PLACE)) != 0);
+    s->is_in_place = ((flags & JS_READ_OBJ_IN_PLACE) != 0);
     s->allow_sab = ((flags & JS_READ_OBJ_SAB) != 0);
     s->allow_reference = ((flags & JS_READ_OBJ_REFERENCE) != 0);
     if (s->allow_bytecode)
@@ -52805,6 +52885,51 @@ uint8_t *JS_GetArrayBuffer(JSContext *ctx, size_t *psize, JSValueConst obj)
     return NULL;
 }
 
+/* no exception is raised, unlike JS_GetArrayBuffer() */
+JS_BOOL JS_IsArrayBuffer(JSValueConst val)
+{
+    JSObject *p;
+    if (JS_VALUE_GET_TAG(val) != JS_TAG_OBJECT)
+        return FALSE;
+    p = JS_VALUE_GET_OBJ(val);
+    return p->class_id == JS_CLASS_ARRAY_BUFFER ||
+        p->class_id == JS_CLASS_SHARED_ARRAY_BUFFER;
+}
+
+/* Return the bytes of an ArrayBuffer, or the bytes viewed by a typed
+   array or a DataView, without copying. Return NULL for any other
+   value or a detached buffer. No exception is raised. */
+uint8_t *JS_GetArrayBufferView(JSContext *ctx, size_t *psize, JSValueConst obj)
+{
+    JSObject *p;
+    JSArrayBuffer *abuf;
+    JSTypedArray *ta;
+
+    *psize = 0;
+    if (JS_VALUE_GET_TAG(obj) != JS_TAG_OBJECT)
+        return NULL;
+    p = JS_VALUE_GET_OBJ(obj);
+    if (p->class_id == JS_CLASS_ARRAY_BUFFER ||
+        p->class_id == JS_CLASS_SHARED_ARRAY_BUFFER) {
+        abuf = p->u.array_buffer;
+        if (abuf->detached)
+            return NULL;
+        *psize = abuf->byte_length;
+        return abuf->data;
+    }
+    if ((p->class_id >= JS_CLASS_UINT8C_ARRAY &&
+         p->class_id <= JS_CLASS_FLOAT64_ARRAY) ||
+        p->class_id == JS_CLASS_DATAVIEW) {
+        ta = p->u.typed_array;
+        abuf = ta->buffer->u.array_buffer;
+        if (abuf->detached)
+            return NULL;
+        *psize = ta->length;
+        return abuf->data + ta->offset;
+    }
+    return NULL;
+}
+
 static JSValue js_array_buffer_slice(JSContext *ctx,
                                      JSValueConst this_val,
                                      int argc, JSValueConst *argv, int class_id)
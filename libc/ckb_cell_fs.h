@@ -11,11 +11,43 @@ typedef struct FSEntry {
     FSBlob content;
 } FSEntry;
 
+// Header of the v2 layout. The v1 layout starts with the file count instead,
+// which can never reach FS_V2_MAGIC.
+#define FS_V2_MAGIC 0x32534643  // "CFS2"
+#define FS_V2_VERSION 2
+
+typedef struct FSHeaderV2 {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    // number of slots of the hash index, a power of two
+    uint32_t index_size;
+    // offsets from the start of the image
+    uint32_t entries_offset;
+    uint32_t index_offset;
+    uint32_t payload_offset;
+    // 0 if no file is compressed. Otherwise the offset of uint32_t[count]: the
+    // uncompressed size of each LZ4 block compressed file, 0 for stored files.
+    uint32_t raw_sizes_offset;
+} FSHeaderV2;
+
+typedef struct FSFile FSFile;
+
 typedef struct FSCellNode {
     uint32_t count;
     FSEntry *files;
     void *start;
     const char *prefix;
+    uint32_t prefix_len;
+    // one handle per entry, filled on first lookup and borrowed by ckb_get_file
+    FSFile *handles;
+    // open addressing hash index over the file names: the slot holds the
+    // entry index plus one, 0 for an empty slot. Built at mount for v1 and
+    // read in place from the image for v2.
+    const uint32_t *index;
+    uint32_t index_mask;
+    // see FSHeaderV2.raw_sizes_offset, NULL when nothing is compressed
+    const uint32_t *raw_sizes;
 } FSCellNode;
 
 typedef struct FSCell {
@@ -23,17 +55,28 @@ typedef struct FSCell {
     struct FSCell *next;
 } FSCell;
 
-typedef struct FSFile {
+struct FSFile {
     const char *filename;
     const void *content;
     uint32_t size;
-    // indicate how many active users there are, used to avoid excessive opening
-    // of the same file.
-    // Currently the only valid values are 1 and 0.
-    uint8_t rc;
-} FSFile;
+    // Files are owned by the mounted file system and shared by all users. For
+    // a stored file this is always 1. For a compressed file it counts the
+    // lookups not released yet, the decompressed content is freed at 0.
+    uint32_t rc;
+    // content is a decompressed copy rather than the cell data itself
+    uint8_t owned;
+};
 
+// The returned file is borrowed from the mounted file system: it must not be
+// freed and stays valid as long as the file system is mounted, or until it is
+// passed to ckb_release_file.
 int ckb_get_file(const char *filename, FSFile **file);
+// Like ckb_get_file, but a missing "<name>.js" falls back to "<name>.bc". The
+// name is hashed once for both candidates.
+int ckb_get_module_file(const char *filename, FSFile **file);
+// Tells the file system the caller is done with the content of `file`, so the
+// memory of a decompressed file can be reclaimed. Stored files are unaffected.
+void ckb_release_file(FSFile *file);
 int ckb_load_fs(const char *prefix, void *buf, uint64_t buflen);
 void ckb_reset_fs();
 
@@ -11,5 +11,47 @@
 size_t malloc_usable_size(void *ptr);
 void malloc_config(uintptr_t min, uintptr_t max);
 size_t malloc_usage();
+void *_sbrk(uintptr_t incr);
+// Bytes of the break holding data that isn't heap, such as the code cell, so
+// that statistics don't count them as fragmentation. Kept in every build.
+void malloc_set_reserved(size_t size);
+
+// Allocator statistics, only maintained in MEMORY_USAGE builds. Besides malloc,
+// allocators that take memory straight from _sbrk report their blocks through
+// the MALLOC_STATS_* hooks. Sizes are what a block takes, including overhead.
+// Class i of alloc_count counts blocks of at most 16 << i bytes, the last
+// class all larger ones.
+#define MALLOC_STATS_CLASS_COUNT 12
+
+struct malloc_stats {
+    size_t alloc_count[MALLOC_STATS_CLASS_COUNT];
+    size_t free_count;
+    size_t realloc_count;
+    size_t realloc_in_place_count;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+    // ckb_current_cycles() when live_bytes last reached peak_live_bytes
+    uint64_t peak_live_cycles;
+    // set by malloc_set_reserved
+    size_t reserved_bytes;
+};
+
+void malloc_get_stats(struct malloc_stats *stats);
+// Prints the statistics and the break usage with printf, prefixed by label
+void malloc_print_stats(const char *label);
+
+#ifdef MEMORY_USAGE
+void malloc_stats_alloc(size_t size);
+void malloc_stats_free(size_t size);
+// A realloc that moved the block also reports the alloc and the free
+void malloc_stats_realloc(size_t old_size, size_t new_size, int in_place);
+#define MALLOC_STATS_ALLOC(size) malloc_stats_alloc(size)
+#define MALLOC_STATS_FREE(size) malloc_stats_free(size)
+#define MALLOC_STATS_REALLOC(old_size, new_size, in_place) malloc_stats_realloc(old_size, new_size, in_place)
+#else
+#define MALLOC_STATS_ALLOC(size)
+#define MALLOC_STATS_FREE(size)
+#define MALLOC_STATS_REALLOC(old_size, new_size, in_place)
+#endif
 
 #endif  // CKB_C_STDLIB_MALLOC_H_
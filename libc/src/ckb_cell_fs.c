@@ -1,57 +1,274 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "ckb_cell_fs.h"
 
 static FSCell *CELL_FILE_SYSTEM = NULL;
 
-static int get_file(const FSCell *fs, const char *filename, FSFile **f) {
-    if (fs == NULL) {
-        return -1;
+#define FNV_OFFSET_BASIS 2166136261u
+
+// FNV-1a, cheap enough to run on every lookup. fs-packer computes the same
+// hash for the index of the v2 layout.
+static uint32_t hash_update(uint32_t hash, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)s[i];
+        hash *= 16777619u;
     }
-    FSFile *file = malloc(sizeof(FSFile));
-    if (file == 0) {
-        return -1;
+    return hash;
+}
+
+static uint32_t hash_filename(const char *filename) {
+    return hash_update(FNV_OFFSET_BASIS, filename, strlen(filename));
+}
+
+static inline const char *entry_filename(const FSCellNode *node, uint32_t i) {
+    return (const char *)node->start + node->files[i].filename.offset;
+}
+
+// Decode one LZ4 block. Returns the number of bytes written to dst, or -1 if
+// the block is malformed or doesn't decode to exactly dst_len bytes.
+static int64_t lz4_decompress(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_len) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + src_len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + dst_len;
+
+    while (ip < iend) {
+        uint32_t token = *ip++;
+        size_t length = token >> 4;
+        if (length == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+        }
+        if ((size_t)(iend - ip) < length || (size_t)(oend - op) < length) return -1;
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+        // the last sequence has literals only
+        if (ip == iend) break;
+
+        if (iend - ip < 2) return -1;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+        length = token & 15;
+        if (length == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return -1;
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+        }
+        length += 4;
+        if ((size_t)(oend - op) < length) return -1;
+        // matches may overlap their source, copy byte by byte
+        const uint8_t *match = op - offset;
+        while (length--) {
+            *op++ = *match++;
+        }
     }
-    FSCell *cfs = (FSCell *)fs;
-    FSCellNode *node = cfs->current;
-    while (node != NULL) {
-        if (strncmp(node->prefix + 1, filename, strlen(node->prefix) - 1) != 0) {
-            if (cfs->next == NULL) {
-                break;
+    return op == oend ? (int64_t)(op - dst) : -1;
+}
+
+static FSFile *file_at(const FSCellNode *node, uint32_t i) {
+    FSFile *file = &node->handles[i];
+    if (file->rc == 0) {
+        FSEntry entry = node->files[i];
+        // TODO: check the memory addresses are legal
+        file->filename = node->start + entry.filename.offset;
+        file->content = node->start + entry.content.offset;
+        file->size = entry.content.length;
+        file->owned = 0;
+        uint32_t raw_size = node->raw_sizes ? node->raw_sizes[i] : 0;
+        if (raw_size != 0) {
+            // Decompressed on first access only and cached in the handle, so
+            // files that are never used cost no decoding at all.
+            uint8_t *raw = malloc(raw_size + 1);
+            if (raw == NULL) {
+                return NULL;
+            }
+            if (lz4_decompress(file->content, file->size, raw, raw_size) < 0) {
+                free(raw);
+                return NULL;
             }
-            cfs = cfs->next;
-            node = cfs->current;
+            // keep the trailing zero required by QuickJS
+            raw[raw_size] = 0;
+            file->content = raw;
+            file->size = raw_size;
+            file->owned = 1;
+        }
+    } else if (!file->owned) {
+        return file;
+    }
+    file->rc++;
+    return file;
+}
+
+void ckb_release_file(FSFile *file) {
+    if (file == NULL || !file->owned || file->rc == 0) {
+        return;
+    }
+    if (--file->rc == 0) {
+        // back to the unfilled state, the next lookup decompresses again
+        free((void *)file->content);
+        file->content = NULL;
+        file->size = 0;
+        file->owned = 0;
+    }
+}
+
+// Look up the entry named `name[0..len)` followed by `suffix`, `hash` being
+// the hash of that full name.
+static int find_file(const FSCellNode *node, const char *name, size_t len, const char *suffix, uint32_t hash,
+                     FSFile **f) {
+    if (node->count == 0) {
+        return -1;
+    }
+    uint32_t slot = hash & node->index_mask;
+    // a full table has no empty slot to stop at, so never probe more than it holds
+    for (uint32_t probes = 0; probes <= node->index_mask && node->index[slot] != 0; probes++) {
+        uint32_t i = node->index[slot] - 1;
+        if (i < node->count && strncmp(name, entry_filename(node, i), len) == 0 &&
+            strcmp(suffix, entry_filename(node, i) + len) == 0) {
+            *f = file_at(node, i);
+            return *f == NULL ? -1 : 0;
+        }
+        slot = (slot + 1) & node->index_mask;
+    }
+    return -1;
+}
+
+// The part of `filename` relative to the mount point of `node`, NULL if the
+// file can't be under that mount point.
+static const char *node_basename(const FSCellNode *node, const char *filename) {
+    if (strncmp(node->prefix + 1, filename, node->prefix_len - 1) != 0) {
+        return NULL;
+    }
+    const char *basename = filename + node->prefix_len - 1;
+    if (node->prefix[node->prefix_len - 1] != '/') {
+        basename++;
+    }
+    return basename;
+}
+
+static int get_file(const FSCell *fs, const char *filename, FSFile **f) {
+    for (const FSCell *cfs = fs; cfs != NULL; cfs = cfs->next) {
+        const FSCellNode *node = cfs->current;
+        const char *basename = node_basename(node, filename);
+        if (basename == NULL) {
             continue;
         }
-        const char *basename = filename + strlen(node->prefix) - 1;
-        if (node->prefix[strlen(node->prefix) - 1] != '/') {
-            basename++;
+        size_t len = strlen(basename);
+        if (find_file(node, basename, len, "", hash_update(FNV_OFFSET_BASIS, basename, len), f) == 0) {
+            return 0;
         }
-        for (uint32_t i = 0; i < node->count; i++) {
-            FSEntry entry = node->files[i];
-            if (strcmp(basename, node->start + entry.filename.offset) == 0) {
-                // TODO: check the memory addresses are legal
-                file->filename = filename;
-                file->size = entry.content.length;
-                file->content = node->start + entry.content.offset;
-                file->rc = 1;
-                *f = file;
+    }
+    return -1;
+}
+
+int ckb_get_file(const char *filename, FSFile **file) { return get_file(CELL_FILE_SYSTEM, filename, file); }
+
+int ckb_get_module_file(const char *filename, FSFile **file) {
+    size_t len = strlen(filename);
+    if (len <= 3 || strcmp(filename + len - 3, ".js") != 0) {
+        return get_file(CELL_FILE_SYSTEM, filename, file);
+    }
+    // foo.js in every mount first, then foo.bc. Both names share everything
+    // up to the extension, so the stem is hashed once for each basename; the
+    // mounts usually share one.
+    static const char *const suffixes[] = {"js", "bc"};
+    const char *hashed = NULL;
+    uint32_t stem_hash = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (const FSCell *cfs = CELL_FILE_SYSTEM; cfs != NULL; cfs = cfs->next) {
+            const FSCellNode *node = cfs->current;
+            const char *basename = node_basename(node, filename);
+            if (basename == NULL || strlen(basename) <= 3) {
+                continue;
+            }
+            size_t stem_len = strlen(basename) - 2;
+            if (basename != hashed) {
+                stem_hash = hash_update(FNV_OFFSET_BASIS, basename, stem_len);
+                hashed = basename;
+            }
+            const char *suffix = suffixes[pass];
+            if (find_file(node, basename, stem_len, suffix, hash_update(stem_hash, suffix, 2), file) == 0) {
                 return 0;
             }
         }
-        if (cfs->next == NULL) {
-            break;
-        }
-        cfs = cfs->next;
-        node = cfs->current;
     }
-    free(file);
     return -1;
 }
 
-int ckb_get_file(const char *filename, FSFile **file) { return get_file(CELL_FILE_SYSTEM, filename, file); }
+// Build the hash index of a v1 node, once per mount.
+static int build_index(FSCellNode *node) {
+    uint32_t size = 2;
+    while (size < node->count * 2) {
+        size <<= 1;
+    }
+    uint32_t *index = (uint32_t *)calloc(size, sizeof(uint32_t));
+    if (index == NULL) {
+        return -1;
+    }
+    node->index = index;
+    node->index_mask = size - 1;
+
+    for (uint32_t i = 0; i < node->count; i++) {
+        const char *filename = entry_filename(node, i);
+        uint32_t slot = hash_filename(filename) & node->index_mask;
+        while (index[slot] != 0) {
+            // keep the first entry of duplicated names, like the former linear scan
+            if (strcmp(filename, entry_filename(node, index[slot] - 1)) == 0) {
+                break;
+            }
+            slot = (slot + 1) & node->index_mask;
+        }
+        if (index[slot] == 0) {
+            index[slot] = i + 1;
+        }
+    }
+    return 0;
+}
+
+// Point the node at the entries and the index of a v2 image, no copy is made.
+static int load_v2(FSCellNode *node, void *buf, uint64_t buflen) {
+    if (buflen < sizeof(FSHeaderV2)) {
+        return -1;
+    }
+    const FSHeaderV2 *header = (const FSHeaderV2 *)buf;
+    // an index at least twice the entry count, as build_index and fs-packer
+    // make it, always has empty slots to end a probe
+    if (header->version != FS_V2_VERSION || header->index_size == 0 ||
+        (header->index_size & (header->index_size - 1)) != 0 ||
+        (uint64_t)header->index_size < (uint64_t)header->count * 2) {
+        return -1;
+    }
+    if (header->entries_offset % 4 != 0 || header->index_offset % 4 != 0 ||
+        (uint64_t)header->entries_offset + (uint64_t)header->count * sizeof(FSEntry) > buflen ||
+        (uint64_t)header->index_offset + (uint64_t)header->index_size * sizeof(uint32_t) > buflen ||
+        header->payload_offset > buflen ||
+        (header->raw_sizes_offset != 0 &&
+         (header->raw_sizes_offset % 4 != 0 ||
+          (uint64_t)header->raw_sizes_offset + (uint64_t)header->count * sizeof(uint32_t) > buflen))) {
+        return -1;
+    }
+    node->count = header->count;
+    node->files = (FSEntry *)((char *)buf + header->entries_offset);
+    node->index = (const uint32_t *)((char *)buf + header->index_offset);
+    node->index_mask = header->index_size - 1;
+    node->start = (char *)buf + header->payload_offset;
+    if (header->raw_sizes_offset != 0) {
+        node->raw_sizes = (const uint32_t *)((char *)buf + header->raw_sizes_offset);
+    }
+    return 0;
+}
 
 static int load_fs(FSCell **fs, const char *prefix, void *buf, uint64_t buflen) {
     if (fs == NULL || buf == NULL) {
@@ -70,7 +287,24 @@ static int load_fs(FSCell **fs, const char *prefix, void *buf, uint64_t buflen)
     }
 
     node->prefix = prefix;
-    node->count = *(uint32_t *)buf;
+    node->prefix_len = strlen(prefix);
+    node->handles = NULL;
+    node->index = NULL;
+    node->index_mask = 0;
+    node->raw_sizes = NULL;
+    bool is_v2 = *(uint32_t *)buf == FS_V2_MAGIC;
+    if (is_v2) {
+        if (load_v2(node, buf, buflen) != 0) {
+            free(node);
+            free(newfs);
+            return -1;
+        }
+    } else {
+        node->count = *(uint32_t *)buf;
+        // the entries are used in place, right after the count
+        node->files = (FSEntry *)((char *)buf + sizeof(node->count));
+        node->start = buf + sizeof(node->count) + (sizeof(FSEntry) * node->count);
+    }
     if (node->count == 0) {
         node->files = NULL;
         node->start = NULL;
@@ -80,24 +314,21 @@ static int load_fs(FSCell **fs, const char *prefix, void *buf, uint64_t buflen)
         return 0;
     }
 
-    node->files = (FSEntry *)malloc(sizeof(FSEntry) * node->count);
-    if (node->files == NULL) {
-        free(node);
-        free(newfs);
-        return -1;
-    }
-    node->start = buf + sizeof(node->count) + (sizeof(FSEntry) * node->count);
-
-    FSEntry *entries = (FSEntry *)((char *)buf + sizeof(node->count));
     for (uint32_t i = 0; i < node->count; i++) {
-        FSEntry entry = entries[i];
-        node->files[i] = entry;
-        char *filename = node->start + entry.filename.offset;
+        const char *filename = entry_filename(node, i);
         if (filename[0] == '.' || filename[0] == '/' || filename[0] == '\\' || filename[0] == '~') {
             return -2;
         }
     }
 
+    node->handles = (FSFile *)calloc(node->count, sizeof(FSFile));
+    if (node->handles == NULL || (!is_v2 && build_index(node) != 0)) {
+        free(node->handles);
+        free(node);
+        free(newfs);
+        return -1;
+    }
+
     newfs->next = *fs;
     newfs->current = node;
     *fs = newfs;
@@ -40,6 +40,7 @@ struct bin {
 #define CKB_PAGE_SIZE 4096
 void __bin_chunk(struct chunk *);
 int ckb_exit(int8_t code);
+uint64_t ckb_current_cycles(void);
 static inline void a_crash() { ckb_exit(-1); }
 void free(void *p);
 
@@ -63,6 +64,64 @@ size_t malloc_usage() {
     return high - low;
 }
 
+static struct malloc_stats s_stats;
+
+void malloc_set_reserved(size_t size) { s_stats.reserved_bytes = size; }
+
+void malloc_get_stats(struct malloc_stats *stats) { *stats = s_stats; }
+
+void malloc_print_stats(const char *label) {
+    size_t brk_used = malloc_usage();
+    size_t heap = brk_used > s_stats.reserved_bytes ? brk_used - s_stats.reserved_bytes : 0;
+    size_t fragmentation = heap > s_stats.live_bytes ? heap - s_stats.live_bytes : 0;
+    printf("%s: brk used %zu, reserved %zu, live %zu, fragmentation %zu, peak live %zu at cycles %llu\n", label,
+           brk_used, s_stats.reserved_bytes, s_stats.live_bytes, fragmentation, s_stats.peak_live_bytes,
+           (unsigned long long)s_stats.peak_live_cycles);
+    printf("%s: frees %zu, reallocs %zu, in place %zu\n", label, s_stats.free_count, s_stats.realloc_count,
+           s_stats.realloc_in_place_count);
+    for (int i = 0; i < MALLOC_STATS_CLASS_COUNT; i++) {
+        if (s_stats.alloc_count[i] == 0) continue;
+        if (i == MALLOC_STATS_CLASS_COUNT - 1) {
+            printf("%s: allocs > %zu: %zu\n", label, (size_t)16 << (i - 1), s_stats.alloc_count[i]);
+        } else {
+            printf("%s: allocs <= %zu: %zu\n", label, (size_t)16 << i, s_stats.alloc_count[i]);
+        }
+    }
+}
+
+#ifdef MEMORY_USAGE
+static void stats_add_live(size_t size) {
+    s_stats.live_bytes += size;
+    if (s_stats.live_bytes > s_stats.peak_live_bytes) {
+        s_stats.peak_live_bytes = s_stats.live_bytes;
+        s_stats.peak_live_cycles = ckb_current_cycles();
+    }
+}
+
+void malloc_stats_alloc(size_t size) {
+    int i = 0;
+    while (i < MALLOC_STATS_CLASS_COUNT - 1 && size > ((size_t)16 << i)) i++;
+    s_stats.alloc_count[i]++;
+    stats_add_live(size);
+}
+
+void malloc_stats_free(size_t size) {
+    s_stats.free_count++;
+    s_stats.live_bytes -= size;
+}
+
+void malloc_stats_realloc(size_t old_size, size_t new_size, int in_place) {
+    s_stats.realloc_count++;
+    if (!in_place) return;
+    s_stats.realloc_in_place_count++;
+    if (new_size > old_size) {
+        stats_add_live(new_size - old_size);
+    } else {
+        s_stats.live_bytes -= old_size - new_size;
+    }
+}
+#endif
+
 void *_sbrk(uintptr_t incr) {
     if (!s_program_break) {
         s_program_break = s_brk_min;
@@ -261,6 +320,7 @@ void *malloc(size_t n) {
         if (c != CKB_BIN_TO_CHUNK(i) && CKB_CHUNK_SIZE(c) - n <= CKB_DONTCARE) {
             unbin(c, i);
             unlock_bin(i);
+            MALLOC_STATS_ALLOC(CKB_CHUNK_SIZE(c));
             return CKB_CHUNK_TO_MEM(c);
         }
         unlock_bin(i);
@@ -283,6 +343,7 @@ void *malloc(size_t n) {
         }
     }
     trim(c, n);
+    MALLOC_STATS_ALLOC(CKB_CHUNK_SIZE(c));
     return CKB_CHUNK_TO_MEM(c);
 }
 
@@ -308,7 +369,10 @@ void *realloc(void *p, size_t n) {
     self = CKB_MEM_TO_CHUNK(p);
     n0 = CKB_CHUNK_SIZE(self);
 
-    if (n <= n0 && n0 - n <= CKB_DONTCARE) return p;
+    if (n <= n0 && n0 - n <= CKB_DONTCARE) {
+        MALLOC_STATS_REALLOC(n0, n0, 1);
+        return p;
+    }
 
     next = CKB_NEXT_CHUNK(self);
 
@@ -323,6 +387,7 @@ void *realloc(void *p, size_t n) {
         self->csize = split->psize = n | CKB_C_INUSE;
         split->csize = next->psize = (n0 - n) | CKB_C_INUSE;
         __bin_chunk(split);
+        MALLOC_STATS_REALLOC(n0, n, 1);
         return CKB_CHUNK_TO_MEM(self);
     }
 
@@ -336,6 +401,7 @@ void *realloc(void *p, size_t n) {
             next = CKB_NEXT_CHUNK(next);
             self->csize = next->psize = (n0 + nsize) | CKB_C_INUSE;
             trim(self, n);
+            MALLOC_STATS_REALLOC(n0, CKB_CHUNK_SIZE(self), 1);
             return CKB_CHUNK_TO_MEM(self);
         }
         unlock_bin(i);
@@ -344,6 +410,7 @@ copy_realloc:
     /* As a last resort, allocate a new chunk and copy to it. */
     new = malloc(n - CKB_OVERHEAD);
     if (!new) return 0;
+    MALLOC_STATS_REALLOC(n0, CKB_CHUNK_SIZE(CKB_MEM_TO_CHUNK(new)), 0);
     memcpy(new, p, (n < n0 ? n : n0) - CKB_OVERHEAD);
     free(CKB_CHUNK_TO_MEM(self));
     return new;
@@ -397,6 +464,7 @@ void __bin_chunk(struct chunk *self) {
 void free(void *p) {
     if (!p) return;
     struct chunk *self = CKB_MEM_TO_CHUNK(p);
+    MALLOC_STATS_FREE(CKB_CHUNK_SIZE(self));
     __bin_chunk(self);
 }
 
@@ -57,7 +57,9 @@ FILE *allocfile() {
 }
 
 void freefile(FILE *file) {
-    file->file->rc -= 1;
+    // file->file is borrowed from the cell file system and shared with other
+    // handles, only the FILE itself is owned here.
+    ckb_release_file(file->file);
     free((void *)file);
 }
 
@@ -15,31 +15,72 @@
 #define CKB_HIGHS (CKB_ONES * (UCHAR_MAX / 2 + 1))
 #define CKB_HASZERO(x) (((x) - CKB_ONES) & ~(x) & CKB_HIGHS)
 
+typedef size_t __attribute__((__may_alias__)) ckb_word;
+
+// The scans below go a word at a time. Reading a whole aligned word never
+// crosses a page, so it is safe to read bytes past the end of a string.
+//
+// ckb_zero_bytes(x) is non-zero iff a byte of x is zero, and its lowest set bit
+// is in the first (lowest addressed) zero byte. With Zbb, orc.b turns every
+// non-zero byte into 0xff, so this takes one instruction.
+#ifdef __riscv_zbb
+static inline size_t ckb_orc_b(size_t x) {
+    size_t r;
+    __asm__("orc.b %0, %1" : "=r"(r) : "r"(x));
+    return r;
+}
+static inline size_t ckb_zero_bytes(size_t x) { return ~ckb_orc_b(x); }
+#else
+static inline size_t ckb_zero_bytes(size_t x) { return CKB_HASZERO(x); }
+#endif
+
+// Offset of the byte holding the lowest set bit of mask, ctz with Zbb
+static inline size_t ckb_first_byte(size_t mask) { return (size_t)__builtin_ctzl(mask) / 8; }
+
+// Unsigned comparison of two words as byte strings, rev8 with Zbb
+static inline int ckb_word_cmp(size_t l, size_t r) { return __builtin_bswap64(l) < __builtin_bswap64(r) ? -1 : 1; }
+
 void *memchr(const void *src, int c, size_t n) {
     const unsigned char *s = src;
     c = (unsigned char)c;
-#ifdef __GNUC__
     for (; ((uintptr_t)s & CKB_ALIGN) && n && *s != c; s++, n--);
     if (n && *s != c) {
-        typedef size_t __attribute__((__may_alias__)) word;
-        const word *w;
+        const ckb_word *w;
         size_t k = CKB_ONES * c;
-        for (w = (const void *)s; n >= CKB_SS && !CKB_HASZERO(*w ^ k); w++, n -= CKB_SS);
+        for (w = (const void *)s; n >= CKB_SS; w++, n -= CKB_SS) {
+            size_t m = ckb_zero_bytes(*w ^ k);
+            if (m) return (unsigned char *)w + ckb_first_byte(m);
+        }
         s = (const void *)w;
     }
-#endif
     for (; n && *s != c; s++, n--);
     return n ? (void *)s : 0;
 }
 
+size_t strlen(const char *s) {
+    size_t offset = (uintptr_t)s & CKB_ALIGN;
+    const ckb_word *w = (const void *)(s - offset);
+    // Bytes of the first word before s are made non-zero
+    size_t x = *w | (((size_t)1 << (8 * offset)) - 1);
+    size_t m;
+    while (!(m = ckb_zero_bytes(x))) x = *++w;
+    return (const char *)w + ckb_first_byte(m) - s;
+}
+
 #define BITOP(a, b, op) ((a)[(size_t)(b) / (8 * sizeof *(a))] op(size_t) 1 << ((size_t)(b) % (8 * sizeof *(a))))
 
 char *__strchrnul(const char *s, int c) {
     c = (unsigned char)c;
     if (!c) return (char *)s + strlen(s);
 
-    for (; *s && *(unsigned char *)s != c; s++);
-    return (char *)s;
+    for (; (uintptr_t)s & CKB_ALIGN; s++) {
+        if (!*s || *(unsigned char *)s == c) return (char *)s;
+    }
+    const ckb_word *w = (const void *)s;
+    size_t k = CKB_ONES * c;
+    size_t m;
+    while (!(m = ckb_zero_bytes(*w) | ckb_zero_bytes(*w ^ k))) w++;
+    return (char *)w + ckb_first_byte(m);
 }
 
 char *strchr(const char *s, int c) {
@@ -47,6 +88,87 @@ char *strchr(const char *s, int c) {
     return *(unsigned char *)r == (unsigned char)c ? r : 0;
 }
 
+int strcmp(const char *_l, const char *_r) {
+    const unsigned char *l = (void *)_l, *r = (void *)_r;
+    if ((((uintptr_t)l ^ (uintptr_t)r) & CKB_ALIGN) == 0) {
+        for (; (uintptr_t)l & CKB_ALIGN; l++, r++) {
+            if (!*l || *l != *r) return *l - *r;
+        }
+        const ckb_word *wl = (const void *)l, *wr = (const void *)r;
+        for (; *wl == *wr && !ckb_zero_bytes(*wl); wl++, wr++);
+        // The words differ or hold the end, finish byte by byte
+        l = (const void *)wl;
+        r = (const void *)wr;
+    }
+    for (; *l && *l == *r; l++, r++);
+    return *l - *r;
+}
+
+int memcmp(const void *vl, const void *vr, size_t n) {
+    const unsigned char *l = vl, *r = vr;
+    if ((((uintptr_t)l ^ (uintptr_t)r) & CKB_ALIGN) == 0) {
+        for (; ((uintptr_t)l & CKB_ALIGN) && n; l++, r++, n--) {
+            if (*l != *r) return *l - *r;
+        }
+        const ckb_word *wl = (const void *)l, *wr = (const void *)r;
+        for (; n >= CKB_SS; wl++, wr++, n -= CKB_SS) {
+            if (*wl != *wr) return ckb_word_cmp(*wl, *wr);
+        }
+        l = (const void *)wl;
+        r = (const void *)wr;
+    }
+    for (; n && *l == *r; n--, l++, r++);
+    return n ? *l - *r : 0;
+}
+
+void *memset(void *dest, int c, size_t n) {
+    unsigned char *s = dest;
+    for (; ((uintptr_t)s & CKB_ALIGN) && n; s++, n--) *s = c;
+    ckb_word *w = (void *)s;
+    size_t k = CKB_ONES * (unsigned char)c;
+    for (; n >= 4 * CKB_SS; w += 4, n -= 4 * CKB_SS) {
+        w[0] = k;
+        w[1] = k;
+        w[2] = k;
+        w[3] = k;
+    }
+    for (; n >= CKB_SS; w++, n -= CKB_SS) *w = k;
+    for (s = (void *)w; n; s++, n--) *s = c;
+    return dest;
+}
+
+void *memcpy(void *restrict dest, const void *restrict src, size_t n) {
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+    for (; ((uintptr_t)d & CKB_ALIGN) && n; d++, s++, n--) *d = *s;
+    ckb_word *wd = (void *)d;
+    size_t shift = 8 * ((uintptr_t)s & CKB_ALIGN);
+    if (shift == 0) {
+        const ckb_word *ws = (const void *)s;
+        for (; n >= 4 * CKB_SS; wd += 4, ws += 4, n -= 4 * CKB_SS) {
+            wd[0] = ws[0];
+            wd[1] = ws[1];
+            wd[2] = ws[2];
+            wd[3] = ws[3];
+        }
+        for (; n >= CKB_SS; wd++, ws++, n -= CKB_SS) *wd = *ws;
+        s = (const void *)ws;
+    } else if (n >= CKB_SS) {
+        // Each destination word is merged from the two aligned source words
+        // it straddles
+        const ckb_word *ws = (const void *)(s - shift / 8);
+        size_t lo = *ws++;
+        for (; n >= CKB_SS; wd++, n -= CKB_SS) {
+            size_t hi = *ws++;
+            *wd = (lo >> shift) | (hi << (8 * CKB_SS - shift));
+            lo = hi;
+        }
+        s = (const unsigned char *)ws - CKB_SS + shift / 8;
+    }
+    for (d = (void *)wd; n; d++, s++, n--) *d = *s;
+    return dest;
+}
+
 int strncmp(const char *_l, const char *_r, size_t n) {
     const unsigned char *l = (void *)_l, *r = (void *)_r;
     if (!n--) return 0;
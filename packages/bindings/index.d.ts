@@ -1,5 +1,11 @@
 type SourceType = number | bigint;
 
+/**
+ * Bytes accepted by the bindings: an ArrayBuffer, or a TypedArray or DataView
+ * of which only the viewed bytes are used, without copying
+ */
+type BytesView = ArrayBuffer | ArrayBufferView;
+
 /**
  * Source constants for loading cells/inputs/headers
  * Used as parameters in load functions to specify data source
@@ -159,6 +165,25 @@ export function loadWitness(
   length?: number,
 ): ArrayBuffer;
 
+/**
+ * Load witness data into an existing buffer, with a single syscall and no allocation
+ * @param buffer - The buffer to write into
+ * @param bufferOffset - The offset in the buffer to start writing at
+ * @param index - The index of the witness
+ * @param source - The source of the witness (use SOURCE_* constants)
+ * @param offset - Optional starting offset in the data (defaults to 0)
+ * @returns The full length of the witness from `offset`. Only
+ * `Math.min(length, buffer.byteLength - bufferOffset)` bytes are written, so a
+ * result larger than the space left means the data was truncated.
+ */
+export function loadWitnessInto(
+  buffer: BytesView,
+  bufferOffset: number,
+  index: number,
+  source: SourceType,
+  offset?: number,
+): number;
+
 /**
  * Load cell data from the transaction
  * @param index - The index of the cell
@@ -174,6 +199,35 @@ export function loadCellData(
   length?: number,
 ): ArrayBuffer;
 
+/**
+ * Load cell data into an existing buffer, with a single syscall and no allocation
+ * @param buffer - The buffer to write into
+ * @param bufferOffset - The offset in the buffer to start writing at
+ * @param index - The index of the cell
+ * @param source - The source of the cell (use SOURCE_* constants)
+ * @param offset - Optional starting offset in the data (defaults to 0)
+ * @returns The full length of the cell data from `offset`. Only
+ * `Math.min(length, buffer.byteLength - bufferOffset)` bytes are written, so a
+ * result larger than the space left means the data was truncated.
+ */
+export function loadCellDataInto(
+  buffer: BytesView,
+  bufferOffset: number,
+  index: number,
+  source: SourceType,
+  offset?: number,
+): number;
+
+/**
+ * Sum the UDT amounts of all cells in a source
+ * @param source - The source of the cells (use SOURCE_* constants)
+ * @param offset - Optional offset of the amount in the cell data (defaults to 0)
+ * @returns The sum of the little-endian u128 amounts stored at `offset` of each cell data
+ * @throws Error with errorCode LENGTH_NOT_ENOUGH if a cell data is too short for an
+ * amount, or if the sum overflows u128
+ */
+export function sumUdtAmount(source: SourceType, offset?: number): bigint;
+
 /**
  * Load cell data by specific field
  * @param index - The index of the cell
@@ -191,6 +245,23 @@ export function loadCellByField(
   length?: number,
 ): ArrayBuffer;
 
+/**
+ * Load a field of consecutive cells in one call
+ * @param source - The source of the cells (use SOURCE_* constants)
+ * @param field - The field to load (use CELL_FIELD_* constants)
+ * @param start - Optional index of the first cell (defaults to 0)
+ * @param count - Optional maximum number of cells (defaults to all cells up to the end of the source)
+ * @returns The fields packed into `data`, where the field of cell `start + i` is
+ * `data.slice(offsets[i], offsets[i + 1])`. `offsets` has one entry more than the
+ * number of cells loaded. A missing field (e.g. the type of a cell without one) is empty.
+ */
+export function loadCellsByField(
+  source: SourceType,
+  field: number,
+  start?: number,
+  count?: number,
+): { data: ArrayBuffer; offsets: Uint32Array };
+
 /**
  * Load header data by specific field
  * @param index - The index of the header
@@ -246,7 +317,7 @@ export function currentCycles(): number;
  * @param args - Additional arguments to pass to the cell
  */
 export function execCell(
-  codeHash: ArrayBuffer,
+  codeHash: BytesView,
   hashType: number,
   offset: number,
   length: number,
@@ -280,7 +351,7 @@ export interface SpawnArgs {
  * @returns The process ID of the spawned process
  */
 export function spawnCell(
-  codeHash: ArrayBuffer,
+  codeHash: BytesView,
   hashType: number,
   offset: number,
   length: number,
@@ -335,7 +406,7 @@ export function read(fd: number, length: number): ArrayBuffer;
  * - If the write cannot complete fully, it will throw an error
  * - The function blocks until all data is written
  */
-export function write(fd: number, data: ArrayBuffer): void;
+export function write(fd: number, data: BytesView): void;
 
 /**
  * Close a file descriptor
@@ -416,16 +487,106 @@ export function loadFile(path: string): string;
  */
 export function parseExtJSON(json: string): Object;
 
+/**
+ * Compute the SHA256 hash of data in one call, without creating a Sha256 object
+ * @param data - Data to be hashed
+ * @returns The 32-byte hash result
+ */
+export function sha256(data: BytesView): ArrayBuffer;
+
+/**
+ * Compute the Keccak256 hash of data in one call, without creating a Keccak256 object
+ * @param data - Data to be hashed
+ * @returns The 32-byte hash result
+ */
+export function keccak256(data: BytesView): ArrayBuffer;
+
+/**
+ * Compute the RIPEMD160 hash of data in one call, without creating a Ripemd160 object
+ * @param data - Data to be hashed
+ * @returns The 20-byte hash result
+ */
+export function ripemd160(data: BytesView): ArrayBuffer;
+
+/**
+ * Compute the Blake2b-256 hash of data in one call, without creating a Blake2b object
+ * @param data - Data to be hashed
+ * @param personal - Optional personalization string of 16 bytes (defaults to "ckb-default-hash")
+ * @returns The 32-byte hash result
+ */
+export function blake2b256(data: BytesView, personal?: string): ArrayBuffer;
+
+/**
+ * Kinds of data for `updateFromSyscall` of the hash classes
+ */
+export const LOAD_WITNESS: number;
+export const LOAD_CELL_DATA: number;
+export const LOAD_CELL: number;
+export const LOAD_INPUT: number;
+export const LOAD_HEADER: number;
+export const LOAD_TRANSACTION: number;
+export const LOAD_SCRIPT: number;
+
+/**
+ * Hash a witness with Blake2b-256 and the "ckb-default-hash" personalization,
+ * streaming it from the syscall instead of loading it into an ArrayBuffer
+ * @param index - The index of the witness
+ * @param source - The source of the witness (use SOURCE_* constants)
+ * @param offset - Optional starting offset in the witness (defaults to 0)
+ * @param length - Optional number of bytes to hash (defaults to the rest of the witness)
+ * @returns The 32-byte hash
+ */
+export function hashWitness(
+  index: number,
+  source: SourceType,
+  offset?: number,
+  length?: number,
+): ArrayBuffer;
+
+/**
+ * Hash cell data with Blake2b-256 and the "ckb-default-hash" personalization,
+ * streaming it from the syscall instead of loading it into an ArrayBuffer
+ * @param index - The index of the cell
+ * @param source - The source of the cell (use SOURCE_* constants)
+ * @param offset - Optional starting offset in the data (defaults to 0)
+ * @param length - Optional number of bytes to hash (defaults to the rest of the data)
+ * @returns The 32-byte hash
+ */
+export function hashCellData(
+  index: number,
+  source: SourceType,
+  offset?: number,
+  length?: number,
+): ArrayBuffer;
+
 /**
  * SHA256 hash implementation
  */
 export class Sha256 {
   constructor();
   /**
-   * Update the hash with new data
-   * @param data - Data to be hashed
+   * Update the hash with new data. All arguments are hashed in order in a single call.
+   * @param data - Data to be hashed: ArrayBuffers, typed arrays (only the bytes in their
+   * view), or arrays of those
+   */
+  update(...data: (BytesView | BytesView[])[]): void;
+  /**
+   * Update the hash with data loaded by a syscall, without creating it in JS.
+   * The data is loaded in fixed-size chunks, so memory use does not depend on its size.
+   * @param kind - What to load (use LOAD_* constants)
+   * @param index - The index of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param source - The source of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param offset - Optional starting offset in the item (defaults to 0)
+   * @param length - Optional number of bytes to hash (defaults to the rest of the item)
+   * @returns The number of bytes hashed
    */
-  update(data: ArrayBuffer): void;
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): number;
   /**
    * Finalize and get the hash result
    * @returns The 32-byte hash result
@@ -439,10 +600,28 @@ export class Sha256 {
 export class Keccak256 {
   constructor();
   /**
-   * Update the hash with new data
-   * @param data - Data to be hashed
+   * Update the hash with new data. All arguments are hashed in order in a single call.
+   * @param data - Data to be hashed: ArrayBuffers, typed arrays (only the bytes in their
+   * view), or arrays of those
    */
-  update(data: ArrayBuffer): void;
+  update(...data: (BytesView | BytesView[])[]): void;
+  /**
+   * Update the hash with data loaded by a syscall, without creating it in JS.
+   * The data is loaded in fixed-size chunks, so memory use does not depend on its size.
+   * @param kind - What to load (use LOAD_* constants)
+   * @param index - The index of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param source - The source of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param offset - Optional starting offset in the item (defaults to 0)
+   * @param length - Optional number of bytes to hash (defaults to the rest of the item)
+   * @returns The number of bytes hashed
+   */
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): number;
   /**
    * Finalize and get the hash result
    * @returns The 32-byte hash result
@@ -460,10 +639,28 @@ export class Blake2b {
    */
   constructor(personal?: string);
   /**
-   * Update the hash with new data
-   * @param data - Data to be hashed
+   * Update the hash with new data. All arguments are hashed in order in a single call.
+   * @param data - Data to be hashed: ArrayBuffers, typed arrays (only the bytes in their
+   * view), or arrays of those
+   */
+  update(...data: (BytesView | BytesView[])[]): void;
+  /**
+   * Update the hash with data loaded by a syscall, without creating it in JS.
+   * The data is loaded in fixed-size chunks, so memory use does not depend on its size.
+   * @param kind - What to load (use LOAD_* constants)
+   * @param index - The index of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param source - The source of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param offset - Optional starting offset in the item (defaults to 0)
+   * @param length - Optional number of bytes to hash (defaults to the rest of the item)
+   * @returns The number of bytes hashed
    */
-  update(data: ArrayBuffer): void;
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): number;
   /**
    * Finalize and get the hash result
    * @returns The 32-byte hash result as ArrayBuffer
@@ -477,10 +674,28 @@ export class Blake2b {
 export class Ripemd160 {
   constructor();
   /**
-   * Update the hash with new data
-   * @param data - Data to be hashed
+   * Update the hash with new data. All arguments are hashed in order in a single call.
+   * @param data - Data to be hashed: ArrayBuffers, typed arrays (only the bytes in their
+   * view), or arrays of those
+   */
+  update(...data: (BytesView | BytesView[])[]): void;
+  /**
+   * Update the hash with data loaded by a syscall, without creating it in JS.
+   * The data is loaded in fixed-size chunks, so memory use does not depend on its size.
+   * @param kind - What to load (use LOAD_* constants)
+   * @param index - The index of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param source - The source of the item, ignored by LOAD_TRANSACTION and LOAD_SCRIPT
+   * @param offset - Optional starting offset in the item (defaults to 0)
+   * @param length - Optional number of bytes to hash (defaults to the rest of the item)
+   * @returns The number of bytes hashed
    */
-  update(data: ArrayBuffer): void;
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): number;
   /**
    * Finalize and get the hash result
    * @returns The 20-byte hash result
@@ -500,9 +715,9 @@ export const secp256k1: {
    * @returns The recovered raw public key (64-bytes)
    */
   recover(
-    signature: ArrayBuffer,
+    signature: BytesView,
     recoveryId: number,
-    messageHash: ArrayBuffer,
+    messageHash: BytesView,
   ): ArrayBuffer;
 
   /**
@@ -512,7 +727,7 @@ export const secp256k1: {
    * uncompressed (65 bytes)
    * @returns The serialized public key (33 or 65 bytes)
    */
-  serializePubkey(pubkey: ArrayBuffer, compressed?: boolean): ArrayBuffer;
+  serializePubkey(pubkey: BytesView, compressed?: boolean): ArrayBuffer;
 
   /**
    * Parse a serialized public key(compressed or uncompressed) to raw public key. It
@@ -520,7 +735,7 @@ export const secp256k1: {
    * @param serializedPubkey - The serialized format public key (33 or 65 bytes)
    * @returns The parsed raw public key (64-bytes)
    */
-  parsePubkey(serializedPubkey: ArrayBuffer): ArrayBuffer;
+  parsePubkey(serializedPubkey: BytesView): ArrayBuffer;
 
   /**
    * Verify an ECDSA signature
@@ -530,10 +745,36 @@ export const secp256k1: {
    * @returns True if signature is valid, false otherwise
    */
   verify(
-    signature: ArrayBuffer,
-    messageHash: ArrayBuffer,
-    pubkey: ArrayBuffer,
+    signature: BytesView,
+    messageHash: BytesView,
+    pubkey: BytesView,
   ): boolean;
+
+  /**
+   * Verify many ECDSA signatures in one call, e.g. for M-of-N multisig
+   * @param signatures - The 64-byte signatures packed back to back
+   * @param messageHashes - One 32-byte message hash shared by all signatures, or
+   * one per signature packed back to back
+   * @param pubkeys - The raw public keys (64 bytes each) packed back to back
+   * @returns A bitmap of ceil(n / 8) bytes: bit (i % 8) of byte (i / 8) is set when
+   * signature i is valid. Malformed signatures are reported as invalid.
+   */
+  verifyBatch(
+    signatures: BytesView,
+    messageHashes: BytesView,
+    pubkeys: BytesView,
+  ): ArrayBuffer;
+
+  /**
+   * Recover the raw public keys of many signatures in one call
+   * @param signatures - The 65-byte signatures (64 bytes followed by the recovery
+   * ID) packed back to back
+   * @param messageHashes - One 32-byte message hash shared by all signatures, or
+   * one per signature packed back to back
+   * @returns The recovered raw public keys (64 bytes each) packed back to back. The
+   * public key of a signature that can't be recovered is all zeros.
+   */
+  recoverBatch(signatures: BytesView, messageHashes: BytesView): ArrayBuffer;
 };
 
 /**
@@ -547,7 +788,7 @@ export const schnorr: {
    * @param pubkey - The x-only public key to serialize (64 bytes)
    * @returns The serialized x-only public key (32 bytes containing just the X coordinate)
    */
-  serializeXonlyPubkey(pubkey: ArrayBuffer): ArrayBuffer;
+  serializeXonlyPubkey(pubkey: BytesView): ArrayBuffer;
 
   /**
    * Compute tagged SHA256 hash as specified in BIP340.
@@ -557,7 +798,7 @@ export const schnorr: {
    * @param msg - The message data to hash
    * @returns The 32-byte tagged hash result following BIP340 specification
    */
-  taggedSha256(tag: ArrayBuffer, msg: ArrayBuffer): ArrayBuffer;
+  taggedSha256(tag: BytesView, msg: BytesView): ArrayBuffer;
 
   /**
    * Parse a serialized x-only public key from its 32-byte X coordinate.
@@ -566,7 +807,7 @@ export const schnorr: {
    * @param serializedPubkey - The serialized x-only public key (32 bytes X coordinate)
    * @returns The parsed x-only public key (64 bytes containing reconstructed point)
    */
-  parseXonlyPubkey(serializedPubkey: ArrayBuffer): ArrayBuffer;
+  parseXonlyPubkey(serializedPubkey: BytesView): ArrayBuffer;
 
   /**
    * Verify a Schnorr signature according to BIP340 specification.
@@ -577,10 +818,27 @@ export const schnorr: {
    * @returns True if the signature is valid according to BIP340, false otherwise
    */
   verify(
-    signature: ArrayBuffer,
-    messageHash: ArrayBuffer,
-    pubkey: ArrayBuffer,
+    signature: BytesView,
+    messageHash: BytesView,
+    pubkey: BytesView,
   ): boolean;
+
+  /**
+   * Verify many BIP340 signatures with a single combined check, falling back to
+   * verifying them one by one only when it fails, to tell which are invalid
+   * @param signatures - The 64-byte signatures packed back to back
+   * @param messageHashes - One 32-byte message shared by all signatures, or one per
+   * signature packed back to back
+   * @param xonlyPubkeys - The parsed x-only public keys (64 bytes each, see
+   * parseXonlyPubkey) packed back to back
+   * @returns A bitmap of ceil(n / 8) bytes: bit (i % 8) of byte (i / 8) is set when
+   * signature i is valid
+   */
+  verifyBatch(
+    signatures: BytesView,
+    messageHashes: BytesView,
+    xonlyPubkeys: BytesView,
+  ): ArrayBuffer;
 };
 
 /**
@@ -593,14 +851,14 @@ export class Smt {
    * @param key - The key to insert (32 bytes)
    * @param value - The value to insert (32 bytes)
    */
-  insert(key: ArrayBuffer, value: ArrayBuffer): void;
+  insert(key: BytesView, value: BytesView): void;
   /**
    * Verify a Merkle proof
    * @param root - The 32-byte Merkle root
    * @param proof - The proof data
    * @returns True if proof is valid, false otherwise
    */
-  verify(root: ArrayBuffer, proof: ArrayBuffer): boolean;
+  verify(root: BytesView, proof: BytesView): boolean;
 }
 
 /**
@@ -612,7 +870,7 @@ export const hex: {
    * @param data - Data to encode
    * @returns Hex string representation
    */
-  encode(data: ArrayBuffer): string;
+  encode(data: BytesView): string;
   /**
    * Decode hex string to binary data
    * @param hex - Hex string to decode
@@ -630,7 +888,7 @@ export const base64: {
    * @param data - Data to encode
    * @returns Base64 string representation
    */
-  encode(data: ArrayBuffer): string;
+  encode(data: BytesView): string;
   /**
    * Decode base64 string to binary data
    * @param base64 - Base64 string to decode
@@ -654,6 +912,37 @@ export function sprintf(format: string, ...args: any[]): string;
  */
 export function printf(format: string, ...args: any[]): void;
 
+/**
+ * Allocator statistics. Only `brkUsed` and `reservedBytes` are maintained in
+ * regular builds, the other counters need ckb-js-vm built with
+ * `make MEMORY_USAGE=1`. Sizes are in bytes and include allocator overhead.
+ */
+export interface MemoryStats {
+  /** Bytes of the program break in use (heap high-water mark) */
+  brkUsed: number;
+  /** Bytes of the break that aren't heap: the code cell loaded in place */
+  reservedBytes: number;
+  /** Bytes in allocated blocks; brkUsed - reservedBytes - liveBytes is fragmentation */
+  liveBytes: number;
+  /** Highest liveBytes so far */
+  peakLiveBytes: number;
+  /** Cycle count when liveBytes reached peakLiveBytes */
+  peakLiveCycles: number;
+  frees: number;
+  reallocs: number;
+  /** Reallocs that kept the block in place */
+  reallocsInPlace: number;
+  /** Allocation counts, entry i for blocks of at most 16 << i bytes and the last entry for all larger ones */
+  allocsBySize: number[];
+}
+
+/**
+ * Get allocator statistics. Take them before and after a phase of the script
+ * to see how much heap it uses.
+ * @returns The current statistics
+ */
+export function memoryStats(): MemoryStats;
+
 /**
  * Console object for logging and assertions
  */
@@ -702,5 +991,5 @@ export class TextDecoder {
    * @param input - The Uint8Array containing UTF-8 encoded bytes to decode
    * @returns The decoded string
    */
-  decode(input: Uint8Array): string;
+  decode(input: BytesView): string;
 }
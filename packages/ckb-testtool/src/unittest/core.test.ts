@@ -5,6 +5,7 @@ import {
   DEFAULT_SCRIPT_ALWAYS_FAILURE,
   DEFAULT_SCRIPT_ALWAYS_SUCCESS,
   parseAllCycles,
+  parseBootProfile,
   parseRunResult,
   Resource,
   UnitTestClient,
@@ -102,6 +103,30 @@ describe("example", () => {
     expect(parseRunResult(result[0].stdout.toString())).toBe(-1);
     expect(parseAllCycles(result[0].stdout.toString())).toBe(539);
   });
+  test("parseBootProfile", () => {
+    const stdout = [
+      "Script log: [boot-profile] phase=new_runtime cycles=1200",
+      "Script log: [boot-profile] module=lib/a.js cycles=300",
+      "Script log: [boot-profile] phase=entry cycles=3400",
+      "Script log: [boot-profile] lazy_module=./admin.js cycles=700",
+      "Script log: [boot-profile] total cycles=4600",
+      "Run result: 0",
+      "All cycles: 5000(4.9K)",
+      "",
+    ].join("\n");
+    expect(parseBootProfile(stdout)).toEqual({
+      phases: [
+        { name: "new_runtime", cycles: 1200 },
+        { name: "entry", cycles: 3400 },
+      ],
+      modules: [
+        { name: "lib/a.js", cycles: 300, lazy: false },
+        { name: "./admin.js", cycles: 700, lazy: true },
+      ],
+      total: 4600,
+    });
+    expect(parseBootProfile("Run result: 0\nAll cycles: 5000(4.9K)\n")).toBeUndefined();
+  });
   test("signHashInfo", async () => {
     const resource = Resource.default();
     const client = new UnitTestClient(resource);
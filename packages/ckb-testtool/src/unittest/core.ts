@@ -128,6 +128,59 @@ export function parseAllCycles(stdout: string): number {
   );
 }
 
+/**
+ * Cycles spent in each boot phase of ckb-js-vm, in execution order.
+ */
+export type BootProfile = {
+  phases: { name: string; cycles: number }[];
+  // modules loaded from the file system, lazy ones include linking and evaluation
+  modules: { name: string; cycles: number; lazy: boolean }[];
+  total: number;
+};
+
+/**
+ * Parses the boot profile printed by a ckb-js-vm built with `BOOT_PROFILE=1`.
+ * Each phase is reported on its own line, in the format
+ * `[boot-profile] phase=<name> cycles=<value>`, followed by
+ * `[boot-profile] total cycles=<value>`. A failed boot ends with
+ * `[boot-profile] phase=failed cycles=<value>`. Modules are reported as
+ * `[boot-profile] module=<name> cycles=<value>` or
+ * `[boot-profile] lazy_module=<name> cycles=<value>` when they are loaded.
+ * @param stdout - The stdout output as a string.
+ * @returns The parsed boot profile, or undefined if the output has none.
+ */
+export function parseBootProfile(stdout: string): BootProfile | undefined {
+  const phases: { name: string; cycles: number }[] = [];
+  const modules: { name: string; cycles: number; lazy: boolean }[] = [];
+  let total: number | undefined = undefined;
+  for (const line of stdout.split("\n")) {
+    const phase = line.match(/\[boot-profile\] phase=(\S+) cycles=(\d+)/);
+    if (phase) {
+      phases.push({ name: phase[1], cycles: parseInt(phase[2]) });
+      continue;
+    }
+    const loaded = line.match(
+      /\[boot-profile\] (module|lazy_module)=(\S+) cycles=(\d+)/,
+    );
+    if (loaded) {
+      modules.push({
+        name: loaded[2],
+        cycles: parseInt(loaded[3]),
+        lazy: loaded[1] === "lazy_module",
+      });
+      continue;
+    }
+    const sum = line.match(/\[boot-profile\] total cycles=(\d+)/);
+    if (sum) {
+      total = parseInt(sum[1]);
+    }
+  }
+  if (total === undefined) {
+    return undefined;
+  }
+  return { phases, modules, total };
+}
+
 /**
  * Cretae an empty HeaderView.
  * @returns The empty HeaderView.
@@ -192,6 +245,15 @@ export class ScriptVerificationResult {
     return this.cachedCycles;
   }
 
+  /**
+   * Parses the per-phase boot cycles from the stdout output.
+   * Only available when the script runs on a ckb-js-vm built with `BOOT_PROFILE=1`.
+   * @returns The boot profile, or undefined if the script printed none.
+   */
+  get bootProfile(): BootProfile | undefined {
+    return parseBootProfile(this.stdout);
+  }
+
   /**
    * Reports a summary of the script verification process.
    * This method prints a formatted summary of the script verification results,
@@ -399,6 +399,9 @@ export class WitnessArgs extends mol.Entity.Base<
 
 /**
  * @public
+ *
+ * To sum the amounts of all cells in a source inside a script, use
+ * `bindings.sumUdtAmount`, which does it natively in one call.
  */
 export function udtBalanceFrom(dataLike: BytesLike): bigint {
   const data = dataLike.slice(0, 16);
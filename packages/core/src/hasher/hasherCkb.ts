@@ -3,7 +3,7 @@ import { CellInput, CellInputLike } from "../ckb/index";
 import { NumLike, numToBytes } from "../num/index";
 import { CKB_BLAKE2B_PERSONAL } from "./advanced";
 import { Hasher } from "./hasher.js";
-import { Blake2b } from "@ckb-js-std/bindings";
+import { Blake2b, SourceType, blake2b256 } from "@ckb-js-std/bindings";
 
 /**
  * @public
@@ -24,7 +24,8 @@ export class HasherCkb implements Hasher {
     this.outLength = outLength;
   }
   /**
-   * Updates the hash with the given data.
+   * Updates the hash with the given data. Several pieces of data are hashed
+   * in order with a single native call.
    *
    * @param data - The data to update the hash with.
    * @returns The current Hasher instance for chaining.
@@ -32,13 +33,43 @@ export class HasherCkb implements Hasher {
    * @example
    * ```typescript
    * const hasher = new Hasher();
-   * hasher.update("some data").update("more data");
+   * hasher.update("some data").update("more data", "and more");
    * const hash = hasher.digest();
    * ```
    */
 
-  update(data: Bytes): HasherCkb {
-    this.hasher.update(data);
+  update(...data: BytesLike[]): HasherCkb {
+    this.hasher.update(...data);
+    return this;
+  }
+
+  /**
+   * Updates the hash with data loaded by a syscall, streaming it in chunks
+   * instead of loading it into an ArrayBuffer first.
+   *
+   * @param kind - What to load (use `bindings.LOAD_*` constants).
+   * @param index - The index of the item.
+   * @param source - The source of the item.
+   * @param offset - The starting offset in the item. Default is 0.
+   * @param length - The number of bytes to hash. Default is the rest of the item.
+   * @returns The current Hasher instance for chaining.
+   *
+   * @example
+   * ```typescript
+   * const hasher = new HasherCkb();
+   * hasher.updateFromSyscall(bindings.LOAD_WITNESS, 0, bindings.SOURCE_INPUT);
+   * const hash = hasher.digest();
+   * ```
+   */
+
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): HasherCkb {
+    this.hasher.updateFromSyscall(kind, index, source, offset, length);
     return this;
   }
 
@@ -75,9 +106,10 @@ export class HasherCkb implements Hasher {
  */
 
 export function hashCkb(...data: BytesLike[]): Bytes {
-  const hasher = new HasherCkb();
-  data.forEach((d) => hasher.update(d));
-  return hasher.digest();
+  if (data.length === 1) {
+    return blake2b256(data[0], CKB_BLAKE2B_PERSONAL);
+  }
+  return new HasherCkb().update(...data).digest();
 }
 
 /**
@@ -1,6 +1,6 @@
 import { Bytes, BytesLike } from "../bytes/index.js";
 import { Hasher } from "./hasher.js";
-import { Keccak256 } from "@ckb-js-std/bindings";
+import { Keccak256, SourceType } from "@ckb-js-std/bindings";
 
 /**
  * @public
@@ -17,7 +17,8 @@ export class HasherKeecak256 implements Hasher {
   }
 
   /**
-   * Updates the hash with the given data.
+   * Updates the hash with the given data. Several pieces of data are hashed
+   * in order with a single native call.
    *
    * @param data - The data to update the hash with.
    * @returns The current Hasher instance for chaining.
@@ -30,8 +31,31 @@ export class HasherKeecak256 implements Hasher {
    * ```
    */
 
-  update(data: BytesLike): HasherKeecak256 {
-    this.hasher.update(data);
+  update(...data: BytesLike[]): HasherKeecak256 {
+    this.hasher.update(...data);
+    return this;
+  }
+
+  /**
+   * Updates the hash with data loaded by a syscall, streaming it in chunks
+   * instead of loading it into an ArrayBuffer first.
+   *
+   * @param kind - What to load (use `bindings.LOAD_*` constants).
+   * @param index - The index of the item.
+   * @param source - The source of the item.
+   * @param offset - The starting offset in the item. Default is 0.
+   * @param length - The number of bytes to hash. Default is the rest of the item.
+   * @returns The current Hasher instance for chaining.
+   */
+
+  updateFromSyscall(
+    kind: number,
+    index: number,
+    source: SourceType,
+    offset?: number,
+    length?: number,
+  ): HasherKeecak256 {
+    this.hasher.updateFromSyscall(kind, index, source, offset, length);
     return this;
   }
 
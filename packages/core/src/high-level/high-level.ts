@@ -82,6 +82,46 @@ export const OTHER_END_CLOSED = bindings.OTHER_END_CLOSED;
 export const MAX_VMS_SPAWNED = bindings.MAX_VMS_SPAWNED;
 export const MAX_FDS_CREATED = bindings.MAX_FDS_CREATED;
 
+/**
+ * Size of the scratch buffers used by `loadWitness`, `loadWitnessArgs` and
+ * `loadCellData`. Most witnesses and cell data fit, so they are loaded with a
+ * single syscall instead of a length query followed by the actual load.
+ */
+const SCRATCH_SIZE = 1024;
+
+type LoadIntoFunction = (
+  buffer: ArrayBuffer | Uint8Array,
+  bufferOffset: number,
+  index: number,
+  source: bindings.SourceType,
+  offset?: number,
+) => number;
+
+/**
+ * Load data through a `*Into` binding, using `scratch` for the first syscall.
+ * Data larger than the scratch buffer is completed with a second syscall that
+ * only fetches the remaining bytes.
+ */
+function loadWithScratch(
+  scratch: ArrayBuffer,
+  loadInto: LoadIntoFunction,
+  index: number,
+  source: bindings.SourceType,
+): ArrayBuffer {
+  const length = loadInto(scratch, 0, index, source);
+  if (length <= scratch.byteLength) {
+    return scratch.slice(0, length);
+  }
+  const result = new Uint8Array(length);
+  result.set(new Uint8Array(scratch));
+  loadInto(result, scratch.byteLength, index, source, scratch.byteLength);
+  return result.buffer;
+}
+
+const witnessScratch = new ArrayBuffer(SCRATCH_SIZE);
+const witnessArgsScratch = new ArrayBuffer(SCRATCH_SIZE);
+const cellDataScratch = new ArrayBuffer(SCRATCH_SIZE);
+
 /**
  * Load cell
  *
@@ -138,8 +178,12 @@ export function loadWitness(
   index: number,
   source: bindings.SourceType,
 ): ArrayBuffer {
-  let bytes = bindings.loadWitness(index, source);
-  return bytes;
+  return loadWithScratch(
+    witnessScratch,
+    bindings.loadWitnessInto,
+    index,
+    source,
+  );
 }
 
 /**
@@ -162,7 +206,12 @@ export function loadWitnessArgs(
   index: number,
   source: bindings.SourceType,
 ): WitnessArgs {
-  let bytes = bindings.loadWitness(index, source);
+  let bytes = loadWithScratch(
+    witnessArgsScratch,
+    bindings.loadWitnessInto,
+    index,
+    source,
+  );
   return WitnessArgs.fromBytes(bytes);
 }
 
@@ -268,8 +317,12 @@ export function loadCellData(
   index: number,
   source: bindings.SourceType,
 ): ArrayBuffer {
-  let bytes = bindings.loadCellData(index, source);
-  return bytes;
+  return loadWithScratch(
+    cellDataScratch,
+    bindings.loadCellDataInto,
+    index,
+    source,
+  );
 }
 
 /**
@@ -629,6 +682,150 @@ export class QueryIter<T> implements Iterator<T> {
   }
 }
 
+/**
+ * CellFieldIter provides iteration over one field of all cells in a source
+ *
+ * Unlike QueryIter, which crosses into the bindings once per cell, the fields
+ * of all cells are loaded by a single `bindings.loadCellsByField` call when the
+ * iterator is created. Prefer it when visiting every cell of a source.
+ *
+ * @example
+ * ```typescript
+ * const inputsCapacity = cellCapacities(SOURCE_INPUT)
+ *   .toArray()
+ *   .reduce((sum, cap) => sum + cap, 0n);
+ * ```
+ */
+export class CellFieldIter<T> implements Iterator<T> {
+  private data: Bytes;
+  private offsets: Uint32Array;
+  private decode: (bytes: Bytes) => T;
+  private index: number;
+
+  /**
+   * Creates a new CellFieldIter
+   * @param field - The field to load (use CELL_FIELD_* constants)
+   * @param source - The source to load the cells from
+   * @param decode - Converts the field of a cell, which is empty if the field is missing
+   */
+  constructor(
+    field: number,
+    source: bindings.SourceType,
+    decode: (bytes: Bytes) => T,
+  ) {
+    const { data, offsets } = bindings.loadCellsByField(source, field);
+    this.data = data;
+    this.offsets = offsets;
+    this.decode = decode;
+    this.index = 0;
+  }
+
+  /**
+   * Gets the next item in the iteration
+   * @returns The next item or undefined if iteration is complete
+   */
+  next(): IteratorResult<T> {
+    if (this.index + 1 >= this.offsets.length) {
+      return { value: undefined, done: true };
+    }
+    const bytes = this.data.slice(
+      this.offsets[this.index],
+      this.offsets[this.index + 1],
+    );
+    this.index += 1;
+    return { value: this.decode(bytes), done: false };
+  }
+
+  /**
+   * Makes CellFieldIter iterable, allowing it to be used in for...of loops
+   */
+  [Symbol.iterator](): Iterator<T> {
+    return this;
+  }
+
+  /**
+   * Converts the iterator to an array
+   * @returns Array containing all items
+   */
+  toArray(): T[] {
+    const results: T[] = [];
+    for (const item of this) {
+      results.push(item);
+    }
+    return results;
+  }
+}
+
+/**
+ * Iterate over the capacities of all cells in a source
+ *
+ * @param source - The source to load the cells from
+ * @returns An iterator over the cell capacities
+ */
+export function cellCapacities(
+  source: bindings.SourceType,
+): CellFieldIter<bigint> {
+  return new CellFieldIter(bindings.CELL_FIELD_CAPACITY, source, (bytes) =>
+    numFromBytes(bytes),
+  );
+}
+
+/**
+ * Iterate over the lock scripts of all cells in a source
+ *
+ * @param source - The source to load the cells from
+ * @returns An iterator over the lock scripts
+ */
+export function cellLocks(source: bindings.SourceType): CellFieldIter<Script> {
+  return new CellFieldIter(bindings.CELL_FIELD_LOCK, source, (bytes) =>
+    Script.fromBytes(bytes),
+  );
+}
+
+/**
+ * Iterate over the lock script hashes of all cells in a source
+ *
+ * @param source - The source to load the cells from
+ * @returns An iterator over the lock script hashes
+ */
+export function cellLockHashes(
+  source: bindings.SourceType,
+): CellFieldIter<Bytes> {
+  return new CellFieldIter(
+    bindings.CELL_FIELD_LOCK_HASH,
+    source,
+    (bytes) => bytes,
+  );
+}
+
+/**
+ * Iterate over the type scripts of all cells in a source
+ *
+ * @param source - The source to load the cells from
+ * @returns An iterator over the type scripts, null for cells without one
+ */
+export function cellTypes(
+  source: bindings.SourceType,
+): CellFieldIter<Script | null> {
+  return new CellFieldIter(bindings.CELL_FIELD_TYPE, source, (bytes) =>
+    bytes.byteLength === 0 ? null : Script.fromBytes(bytes),
+  );
+}
+
+/**
+ * Iterate over the type script hashes of all cells in a source
+ *
+ * @param source - The source to load the cells from
+ * @returns An iterator over the type script hashes, null for cells without a type script
+ */
+export function cellTypeHashes(
+  source: bindings.SourceType,
+): CellFieldIter<Bytes | null> {
+  return new CellFieldIter(bindings.CELL_FIELD_TYPE_HASH, source, (bytes) =>
+    bytes.byteLength === 0 ? null : bytes,
+  );
+}
+
 /**
  * Find cell by data_hash
  *
@@ -648,22 +845,16 @@ export function findCellByDataHash(
     throw new Error("dataHash must be 32 bytes");
   }
 
-  for (let i = 0; ; i++) {
-    try {
-      const hash = bindings.loadCellByField(
-        i,
-        source,
-        bindings.CELL_FIELD_DATA_HASH,
-      );
-      if (bytesEq(hash, dataHash)) {
-        return i;
-      }
-    } catch (err: any) {
-      if (err.errorCode === bindings.INDEX_OUT_OF_BOUND) {
-        break;
-      }
-      throw err;
+  let i = 0;
+  for (const hash of new CellFieldIter(
+    bindings.CELL_FIELD_DATA_HASH,
+    source,
+    (bytes) => bytes,
+  )) {
+    if (bytesEq(hash, dataHash)) {
+      return i;
     }
+    i++;
   }
   return null;
 }
@@ -686,28 +877,22 @@ export function lookForDepWithHash2(codeHash: Bytes, hashType: number): number {
       ? bindings.CELL_FIELD_TYPE_HASH
       : bindings.CELL_FIELD_DATA_HASH;
 
+  // Missing items are empty and never match
   let current = 0;
-  while (true) {
-    try {
-      const hash = bindings.loadCellByField(
-        current,
-        bindings.SOURCE_CELL_DEP,
-        field,
-      );
-      if (bytesEq(hash, codeHash)) {
-        return current;
-      }
-    } catch (err: any) {
-      if (err.errorCode === bindings.ITEM_MISSING) {
-        // Skip missing items
-      } else if (err.errorCode === bindings.INDEX_OUT_OF_BOUND) {
-        throw err; // Propagate INDEX_OUT_OF_BOUND error
-      } else {
-        throw err; // Propagate other errors
-      }
+  for (const hash of new CellFieldIter(
+    field,
+    bindings.SOURCE_CELL_DEP,
+    (bytes) => bytes,
+  )) {
+    if (bytesEq(hash, codeHash)) {
+      return current;
     }
     current++;
   }
+  // Not found, report it like the syscall running past the last cell dep
+  const err: any = new Error("ckb syscall error");
+  err.errorCode = bindings.INDEX_OUT_OF_BOUND;
+  throw err;
 }
 
 /**
@@ -22,6 +22,20 @@ function hashWitnessToHasher(witness: BytesLike, hasher: Hasher): void {
   hasher.update(witness);
 }
 
+const EMPTY_BUFFER = new ArrayBuffer(0);
+
+// Same as hashWitnessToHasher, streaming the witness from the syscall
+function hashLoadedWitnessToHasher(
+  index: number,
+  source: bindings.SourceType,
+  hasher: HasherCkb,
+): void {
+  // Loading into an empty buffer only returns the length
+  const length = bindings.loadWitnessInto(EMPTY_BUFFER, 0, index, source);
+  hasher.update(numToBytes(length, 8));
+  hasher.updateFromSyscall(bindings.LOAD_WITNESS, index, source);
+}
+
 export function generateSighashAll(): Bytes {
   const hasher = new HasherCkb();
   const txHash = bindings.loadTxHash();
@@ -47,8 +61,7 @@ export function generateSighashAll(): Bytes {
   let index = 1;
   while (true) {
     try {
-      const witness = bindings.loadWitness(index, bindings.SOURCE_GROUP_INPUT);
-      hashWitnessToHasher(witness, hasher);
+      hashLoadedWitnessToHasher(index, bindings.SOURCE_GROUP_INPUT, hasher);
       index++;
     } catch (err: any) {
       if (err.errorCode === bindings.INDEX_OUT_OF_BOUND) {
@@ -75,8 +88,7 @@ export function generateSighashAll(): Bytes {
 
   for (let i = inputsLength; ; i++) {
     try {
-      const witness = bindings.loadWitness(i, bindings.SOURCE_INPUT);
-      hashWitnessToHasher(witness, hasher);
+      hashLoadedWitnessToHasher(i, bindings.SOURCE_INPUT, hasher);
     } catch (err: any) {
       if (err.errorCode === bindings.INDEX_OUT_OF_BOUND) {
         break;
@@ -104,7 +116,7 @@ function main(): number {
     throw new Error("Invalid witness args: missing lock or incorrect length");
   }
 
-  const signature = witness.lock.slice(0, 64);
+  const signature = new Uint8Array(witness.lock, 0, 64);
   const ricId = new Uint8Array(witness.lock)[64];
   const pubkey = bindings.secp256k1.recover(signature, ricId, message);
   const compPubkey = bindings.secp256k1.serializePubkey(pubkey, true);
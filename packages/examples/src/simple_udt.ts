@@ -8,46 +8,15 @@ function main() {
   let script = HighLevel.loadScript();
   // ckb-js-vm has leading 35 bytes args
   let readArgs = script.args.slice(35);
-  for (let lockHash of new HighLevel.QueryIter(
-    (index, source) =>
-      bindings.loadCellByField(index, source, bindings.CELL_FIELD_LOCK_HASH),
-    bindings.SOURCE_INPUT,
-  )) {
+  for (let lockHash of HighLevel.cellLockHashes(bindings.SOURCE_INPUT)) {
     if (bytesEq(lockHash, readArgs)) {
       // owner mode, return immediately
       return 0;
     }
   }
 
-  let inputAmount = [
-    ...new HighLevel.QueryIter(
-      bindings.loadCellData,
-      bindings.SOURCE_GROUP_INPUT,
-    ),
-  ]
-    .map((data) => {
-      if (data.byteLength != 16) {
-        throw `Invalid data length: ${data.byteLength}`;
-      }
-      const n = new BigUint64Array(data);
-      return n[0] | (n[1] << 64n);
-    })
-    .reduce((sum, amount) => sum + amount, 0n);
-
-  let outputAmount = [
-    ...new HighLevel.QueryIter(
-      bindings.loadCellData,
-      bindings.SOURCE_GROUP_OUTPUT,
-    ),
-  ]
-    .map((data) => {
-      if (data.byteLength != 16) {
-        throw `Invalid data length: ${data.byteLength}`;
-      }
-      const n = new BigUint64Array(data);
-      return n[0] | (n[1] << 64n);
-    })
-    .reduce((sum, amount) => sum + amount, 0n);
+  let inputAmount = bindings.sumUdtAmount(bindings.SOURCE_GROUP_INPUT);
+  let outputAmount = bindings.sumUdtAmount(bindings.SOURCE_GROUP_OUTPUT);
 
   log.debug(`verifying amount: ${inputAmount} and ${outputAmount}`);
   if (inputAmount < outputAmount) {
@@ -14,6 +14,155 @@ interface FileMap {
   [key: string]: string;
 }
 
+interface PackOptions {
+  // 1: the original layout, readable by every ckb-js-vm.
+  // 2: aligned, sorted entries with an embedded hash index.
+  version?: 1 | 2;
+  // LZ4 compress files that get smaller, implies version 2. ckb-js-vm
+  // decompresses a file the first time it is opened.
+  compress?: boolean;
+}
+
+// v2 layout, all integers are 32-bit little-endian:
+//   header: magic, version, file count, index slot count,
+//           entries offset, index offset, payload offset, raw sizes offset
+//   entries: FSEntry[count] sorted by file name, offsets relative to payload
+//   index: uint32[slot count], entry index + 1 (0 = empty slot), linear probing
+//   raw sizes: uint32[count], only present when some file is compressed
+//              (raw sizes offset != 0). Non-zero means the content is an LZ4
+//              block decompressing to that many bytes.
+//   payload: null-terminated names, then 8-byte aligned null-terminated contents
+const V2_MAGIC = 0x32534643; // "CFS2"
+const V2_HEADER_SIZE = 32;
+const V2_ALIGN = 8;
+
+function align(n: number, to: number = V2_ALIGN): number {
+  return (n + to - 1) & ~(to - 1);
+}
+
+// FNV-1a over the UTF-8 bytes of the name, must match libc/src/ckb_cell_fs.c
+function hashFileName(name: Buffer): number {
+  let hash = 2166136261;
+  for (const byte of name) {
+    hash ^= byte;
+    hash = Math.imul(hash, 16777619) >>> 0;
+  }
+  return hash >>> 0;
+}
+
+const LZ4_MIN_MATCH = 4;
+const LZ4_LAST_LITERALS = 5;
+const LZ4_MF_LIMIT = 12;
+const LZ4_MAX_OFFSET = 65535;
+const LZ4_HASH_BITS = 16;
+
+function lz4WriteLength(out: number[], length: number): void {
+  while (length >= 255) {
+    out.push(255);
+    length -= 255;
+  }
+  out.push(length);
+}
+
+function lz4WriteSequence(
+  out: number[],
+  input: Buffer,
+  literalStart: number,
+  literalEnd: number,
+  offset: number,
+  matchLength: number,
+): void {
+  const literals = literalEnd - literalStart;
+  const hasMatch = matchLength >= LZ4_MIN_MATCH;
+  const matchCode = hasMatch ? matchLength - LZ4_MIN_MATCH : 0;
+  out.push((Math.min(literals, 15) << 4) | Math.min(matchCode, 15));
+  if (literals >= 15) {
+    lz4WriteLength(out, literals - 15);
+  }
+  for (let i = literalStart; i < literalEnd; i++) {
+    out.push(input[i]);
+  }
+  if (hasMatch) {
+    out.push(offset & 0xff, offset >> 8);
+    if (matchCode >= 15) {
+      lz4WriteLength(out, matchCode - 15);
+    }
+  }
+}
+
+// Greedy LZ4 block compressor. Its output is a raw block (no frame), decoded
+// by lz4_decompress in libc/src/ckb_cell_fs.c.
+function lz4Compress(input: Buffer): Buffer {
+  const out: number[] = [];
+  const table = new Int32Array(1 << LZ4_HASH_BITS).fill(-1);
+  const hash = (i: number) =>
+    Math.imul(input.readUInt32LE(i), 2654435761) >>> (32 - LZ4_HASH_BITS);
+  // the last match must start at least 12 bytes before the end and the last
+  // 5 bytes are always literals
+  const matchLimit = input.length - LZ4_MF_LIMIT;
+  let anchor = 0;
+  let i = 0;
+  while (i <= matchLimit) {
+    const h = hash(i);
+    const candidate = table[h];
+    table[h] = i;
+    if (
+      candidate < 0 ||
+      i - candidate > LZ4_MAX_OFFSET ||
+      input.readUInt32LE(candidate) !== input.readUInt32LE(i)
+    ) {
+      i++;
+      continue;
+    }
+    let length = LZ4_MIN_MATCH;
+    const end = input.length - LZ4_LAST_LITERALS;
+    while (i + length < end && input[candidate + length] === input[i + length]) {
+      length++;
+    }
+    lz4WriteSequence(out, input, anchor, i, i - candidate, length);
+    i += length;
+    anchor = i;
+  }
+  lz4WriteSequence(out, input, anchor, input.length, 0, 0);
+  return Buffer.from(out);
+}
+
+function lz4Decompress(input: Buffer, rawSize: number): Buffer {
+  const out = Buffer.alloc(rawSize);
+  let ip = 0;
+  let op = 0;
+  const readLength = (length: number) => {
+    if (length === 15) {
+      let b;
+      do {
+        b = input[ip++];
+        length += b;
+      } while (b === 255);
+    }
+    return length;
+  };
+  while (ip < input.length) {
+    const token = input[ip++];
+    const literals = readLength(token >> 4);
+    input.copy(out, op, ip, ip + literals);
+    ip += literals;
+    op += literals;
+    if (ip >= input.length) {
+      break;
+    }
+    const offset = input[ip] | (input[ip + 1] << 8);
+    ip += 2;
+    const length = readLength(token & 15) + LZ4_MIN_MATCH;
+    for (let j = 0; j < length; j++, op++) {
+      out[op] = out[op - offset];
+    }
+  }
+  if (op !== rawSize) {
+    throw new Error("Corrupted compressed file");
+  }
+  return out;
+}
+
 async function getFileSize(filePath: string): Promise<number> {
   const stats = await fs.stat(filePath);
   return stats.size;
@@ -60,10 +209,94 @@ async function appendIntegerToStream(
   await writeToFile(buffer, stream);
 }
 
+async function packV2(
+  files: FileMap,
+  outputStream: fsSync.WriteStream,
+  compress: boolean = false,
+): Promise<void> {
+  const names = Object.keys(files).sort((a, b) =>
+    Buffer.compare(Buffer.from(a), Buffer.from(b)),
+  );
+  const count = names.length;
+  let slots = 2;
+  while (slots < count * 2) {
+    slots <<= 1;
+  }
+  const entriesOffset = V2_HEADER_SIZE;
+  const indexOffset = entriesOffset + count * 16;
+
+  const nameBuffers = names.map((name) => Buffer.from(name + "\0"));
+  const contents: Buffer[] = [];
+  const rawSizes: number[] = [];
+  for (const name of names) {
+    console.log(`packing file ${files[name]} to ${name}`);
+    const content = await fs.readFile(files[name]);
+    const compressed = compress ? lz4Compress(content) : content;
+    if (compressed.length < content.length) {
+      contents.push(compressed);
+      rawSizes.push(content.length);
+    } else {
+      contents.push(content);
+      rawSizes.push(0);
+    }
+  }
+  const hasCompressed = rawSizes.some((size) => size !== 0);
+  const rawSizesOffset = hasCompressed ? indexOffset + slots * 4 : 0;
+  const payloadOffset = align(
+    indexOffset + slots * 4 + (hasCompressed ? count * 4 : 0),
+  );
+
+  let payloadSize = nameBuffers.reduce((sum, b) => sum + b.length, 0);
+  const contentOffsets: number[] = [];
+  for (const content of contents) {
+    // contents are aligned relative to the whole image
+    payloadSize = align(payloadOffset + payloadSize) - payloadOffset;
+    contentOffsets.push(payloadSize);
+    payloadSize += content.length + 1;
+  }
+
+  const image = Buffer.alloc(align(payloadOffset + payloadSize));
+  image.writeUInt32LE(V2_MAGIC, 0);
+  image.writeUInt32LE(2, 4);
+  image.writeUInt32LE(count, 8);
+  image.writeUInt32LE(slots, 12);
+  image.writeUInt32LE(entriesOffset, 16);
+  image.writeUInt32LE(indexOffset, 20);
+  image.writeUInt32LE(payloadOffset, 24);
+  image.writeUInt32LE(rawSizesOffset, 28);
+
+  let nameOffset = 0;
+  for (let i = 0; i < count; i++) {
+    const entry = entriesOffset + i * 16;
+    image.writeUInt32LE(nameOffset, entry);
+    image.writeUInt32LE(nameBuffers[i].length - 1, entry + 4);
+    image.writeUInt32LE(contentOffsets[i], entry + 8);
+    image.writeUInt32LE(contents[i].length, entry + 12);
+    nameBuffers[i].copy(image, payloadOffset + nameOffset);
+    contents[i].copy(image, payloadOffset + contentOffsets[i]);
+    nameOffset += nameBuffers[i].length;
+    if (hasCompressed) {
+      image.writeUInt32LE(rawSizes[i], rawSizesOffset + i * 4);
+    }
+
+    let slot = hashFileName(nameBuffers[i].subarray(0, -1)) & (slots - 1);
+    while (image.readUInt32LE(indexOffset + slot * 4) !== 0) {
+      slot = (slot + 1) & (slots - 1);
+    }
+    image.writeUInt32LE(i + 1, indexOffset + slot * 4);
+  }
+
+  await writeToFile(image, outputStream);
+}
+
 async function pack(
   files: FileMap,
   outputStream: fsSync.WriteStream,
+  options: PackOptions = {},
 ): Promise<void> {
+  if (options.version === 2 || options.compress) {
+    return packV2(files, outputStream, options.compress);
+  }
   const numFiles = Object.keys(files).length;
   await appendIntegerToStream(numFiles, outputStream);
 
@@ -117,6 +350,7 @@ async function unpack(directory: string, fileContent: Buffer): Promise<void> {
     filename: string,
     offset: number,
     length: number,
+    rawSize: number,
   ): Promise<void> {
     const normalizedFilename = filename.replace(/\//g, path.sep);
     const filePath = path.join(directory, normalizedFilename);
@@ -125,11 +359,29 @@ async function unpack(directory: string, fileContent: Buffer): Promise<void> {
     await createDirectory(dir);
     console.log(`unpacking file ${filename} to ${filePath}`);
 
-    const content = fileContent.slice(offset, offset + length);
+    let content = fileContent.slice(offset, offset + length);
+    if (rawSize !== 0) {
+      content = lz4Decompress(content, rawSize);
+    }
     await fs.writeFile(filePath, content);
   }
 
-  const numFiles = readInteger();
+  let numFiles = readInteger();
+  let blobStart = 0;
+  let rawSizesOffset = 0;
+  if (numFiles === V2_MAGIC) {
+    const version = readInteger();
+    if (version !== 2) {
+      throw new Error(`Unsupported file system version: ${version}`);
+    }
+    numFiles = readInteger();
+    readInteger(); // index slot count
+    const entriesOffset = readInteger();
+    readInteger(); // index offset
+    blobStart = readInteger();
+    rawSizesOffset = readInteger();
+    position = entriesOffset;
+  }
   const metadata: FileMetadata[] = [];
 
   // Read metadata
@@ -142,9 +394,11 @@ async function unpack(directory: string, fileContent: Buffer): Promise<void> {
     });
   }
 
-  const blobStart = position;
+  if (blobStart === 0) {
+    blobStart = position;
+  }
 
-  for (const metadatum of metadata) {
+  for (const [i, metadatum] of metadata.entries()) {
     position = blobStart + metadatum.fileNameOffset;
     const filename = readStringNull(metadatum.fileNameLength);
     position = blobStart + metadatum.fileContentOffset;
@@ -153,6 +407,9 @@ async function unpack(directory: string, fileContent: Buffer): Promise<void> {
       filename,
       position,
       metadatum.fileContentLength,
+      rawSizesOffset === 0
+        ? 0
+        : fileContent.readUInt32LE(rawSizesOffset + i * 4),
     );
   }
 }
@@ -183,15 +440,22 @@ function usage(msg?: string): void {
   console.log(`ckb-fs-packer - A utility for packing and unpacking files
 
 Usage:
-  ckb-fs-packer pack <output_file> [<read_path>[:<fs_path>]...]    Pack files into a single archive
-  ckb-fs-packer unpack <input_file> [directory]                    Extract files from an archive
+  ckb-fs-packer pack [--v2] [--compress] <output_file> [<read_path>[:<fs_path>]...]
+                                                                   Pack files into a single archive
+  ckb-fs-packer unpack <input_file> [directory]                           Extract files from an archive
 
 Options:
+  --v2                                                             Use the v2 layout: aligned contents and a
+                                                                   precomputed lookup table (needs a recent ckb-js-vm)
+  --compress                                                       LZ4 compress files that shrink, implies --v2.
+                                                                   Files are decompressed on first access
   -h, --help                                                       Show this help message
 
 Examples:
   ckb-fs-packer pack archive.fs file1.txt:docs/file1.txt file2.js:lib/file2.js
   ckb-fs-packer pack archive.fs file1.txt                          # Uses same path for both
+  ckb-fs-packer pack --v2 archive.fs file1.txt
+  ckb-fs-packer pack --compress archive.fs file1.txt
   ckb-fs-packer unpack archive.fs ./extracted
 
 Note: Files can also be provided via stdin when packing.`);
@@ -210,6 +474,15 @@ function parseFilePathMapping(input: string): {
 }
 
 async function doPack(): Promise<void> {
+  const options: PackOptions = {};
+  while (["--v2", "--compress"].includes(process.argv[3])) {
+    if (process.argv[3] === "--v2") {
+      options.version = 2;
+    } else {
+      options.compress = true;
+    }
+    process.argv.splice(3, 1);
+  }
   if (process.argv.length === 2) {
     usage("You must specify the output file.");
     process.exit(1);
@@ -246,7 +519,7 @@ async function doPack(): Promise<void> {
     process.exit(1);
   }
 
-  await pack(files, stream);
+  await pack(files, stream, options);
   stream.end();
 }
 
@@ -298,4 +571,4 @@ if (require.main === module) {
 }
 
 // Export the functions for use as a module
-export { pack, unpack, FileMap, FileMetadata };
+export { pack, unpack, FileMap, FileMetadata, PackOptions };
@@ -14,6 +14,10 @@ const mappedFiles = [
   "src/index.ts:another/location/index.ts",
 ];
 const mappedPakFile = "test-mapped.pak";
+const v2PakFile = "test-v2.pak";
+const v2OutputDir = "test-output-v2";
+const compressedPakFile = "test-compressed.pak";
+const compressedOutputDir = "test-output-compressed";
 // Binary path configuration
 const binaryPath = process.env.BINARY_PATH || "node dist.commonjs/index.js";
 
@@ -69,7 +73,29 @@ async function runTests() {
     process.exit(1);
   }
 
-  // Step 6: Compare files
+  // Step 6: Pack and unpack files with the v2 layout
+  console.log("\nTesting v2 layout...");
+  const packV2Command = `${binaryPath} pack --v2 ${v2PakFile} ${testFiles.join(" ")}`;
+  if (!runCommand(packV2Command)) {
+    process.exit(1);
+  }
+  const unpackV2Command = `${binaryPath} unpack ${v2PakFile} ${v2OutputDir}`;
+  if (!runCommand(unpackV2Command)) {
+    process.exit(1);
+  }
+
+  // Step 6b: Pack and unpack compressed files
+  console.log("\nTesting compressed files...");
+  const packCompressedCommand = `${binaryPath} pack --compress ${compressedPakFile} ${testFiles.join(" ")}`;
+  if (!runCommand(packCompressedCommand)) {
+    process.exit(1);
+  }
+  const unpackCompressedCommand = `${binaryPath} unpack ${compressedPakFile} ${compressedOutputDir}`;
+  if (!runCommand(unpackCompressedCommand)) {
+    process.exit(1);
+  }
+
+  // Step 7: Compare files
   console.log("Comparing files...");
   let allPassed = true;
 
@@ -93,7 +119,57 @@ async function runTests() {
     }
   }
 
-  // Step 7: Compare mapped files
+  // Step 8: Compare v2 files
+  console.log("\nComparing v2 files...");
+  const v2Image = fs.readFileSync(v2PakFile);
+  if (v2Image.readUInt32LE(0) !== 0x32534643) {
+    console.error(`❌ ${v2PakFile}: missing v2 header`);
+    allPassed = false;
+  }
+  for (const file of testFiles) {
+    try {
+      const originalContent = fs.readFileSync(file);
+      const unpackedContent = fs.readFileSync(path.join(v2OutputDir, file));
+
+      if (Buffer.compare(originalContent, unpackedContent) === 0) {
+        console.log(`✅ ${file} (v2): Files match`);
+      } else {
+        console.error(`❌ ${file} (v2): Files do not match`);
+        allPassed = false;
+      }
+    } catch (error) {
+      console.error(`❌ Error comparing ${file} (v2): ${error.message}`);
+      allPassed = false;
+    }
+  }
+
+  // Step 8b: Compare compressed files
+  console.log("\nComparing compressed files...");
+  const compressedImage = fs.readFileSync(compressedPakFile);
+  if (compressedImage.readUInt32LE(28) === 0) {
+    console.error(`❌ ${compressedPakFile}: no compressed file`);
+    allPassed = false;
+  }
+  for (const file of testFiles) {
+    try {
+      const originalContent = fs.readFileSync(file);
+      const unpackedContent = fs.readFileSync(
+        path.join(compressedOutputDir, file),
+      );
+
+      if (Buffer.compare(originalContent, unpackedContent) === 0) {
+        console.log(`✅ ${file} (compressed): Files match`);
+      } else {
+        console.error(`❌ ${file} (compressed): Files do not match`);
+        allPassed = false;
+      }
+    } catch (error) {
+      console.error(`❌ Error comparing ${file} (compressed): ${error.message}`);
+      allPassed = false;
+    }
+  }
+
+  // Step 9: Compare mapped files
   console.log("\nComparing mapped files...");
   for (const mappedFile of mappedFiles) {
     const [sourceFile, destFile] = mappedFile.split(":");
@@ -9,6 +9,7 @@
 #include "qjs.h"
 #include "utils.h"
 #include "ckb_consts.h"
+#include "malloc.h"
 
 // For syscalls supporting partial loading, the arguments are described as:
 // argument 1: index
@@ -16,7 +17,6 @@
 // argument 3: offset (optional, default to 0)
 // argument 4: length (optional, default to full length)
 //
-#define NO_VALUE ((size_t)-1)
 // a temporary error code which should be not returned to exit
 #define ERROR_TEMP (-100)
 
@@ -47,7 +47,7 @@ JSValue qjs_throw_error(JSContext *ctx, int32_t error_code, const char *message)
     return ret;
 }
 
-static void my_free(JSRuntime *rt, void *opaque, void *_ptr) { free(opaque); }
+static void my_free(JSRuntime *rt, void *opaque, void *_ptr) { js_free_rt(rt, opaque); }
 struct LoadData;
 typedef int (*LoadFunc)(void *addr, uint64_t *len, struct LoadData *data);
 
@@ -60,26 +60,28 @@ typedef struct LoadData {
     LoadFunc func;
 } LoadData;
 
-static JSValue parse_args(JSContext *ctx, LoadData *data, bool has_field, int argc, JSValueConst *argv, LoadFunc func) {
+// argv[0] is argument `first` of the JS call, the position reported in errors
+static JSValue parse_args_from(JSContext *ctx, LoadData *data, bool has_field, int argc, JSValueConst *argv,
+                               LoadFunc func, int first) {
     int64_t index;
     int64_t source;
     int64_t length = NO_VALUE;
     int64_t offset = NO_VALUE;
     int64_t field = NO_VALUE;
-    if (qjs_bad_int_arg(ctx, argv[0], 0)) {
+    if (qjs_bad_int_arg(ctx, argv[0], first)) {
         return JS_EXCEPTION;
     }
     if (JS_ToInt64(ctx, &index, argv[0])) {
         return JS_EXCEPTION;
     }
-    if (qjs_bad_bigint_arg(ctx, argv[1], 1)) {
+    if (qjs_bad_bigint_arg(ctx, argv[1], first + 1)) {
         return JS_EXCEPTION;
     }
     if (JS_ToInt64Ext(ctx, &source, argv[1])) return JS_EXCEPTION;
     int var_arg_index = 2;
     if (has_field) {
         if (argc > 2) {
-            if (qjs_bad_int_arg(ctx, argv[2], 2)) {
+            if (qjs_bad_int_arg(ctx, argv[2], first + 2)) {
                 return JS_EXCEPTION;
             }
             if (JS_ToInt64(ctx, &field, argv[2])) {
@@ -89,7 +91,7 @@ static JSValue parse_args(JSContext *ctx, LoadData *data, bool has_field, int ar
         var_arg_index = 3;
     }
     if (argc > var_arg_index) {
-        if (qjs_bad_int_arg(ctx, argv[var_arg_index], var_arg_index)) {
+        if (qjs_bad_int_arg(ctx, argv[var_arg_index], first + var_arg_index)) {
             return JS_EXCEPTION;
         }
         if (JS_ToInt64(ctx, &offset, argv[var_arg_index])) {
@@ -97,7 +99,7 @@ static JSValue parse_args(JSContext *ctx, LoadData *data, bool has_field, int ar
         }
     }
     if (argc > (var_arg_index + 1)) {
-        if (qjs_bad_int_arg(ctx, argv[var_arg_index + 1], var_arg_index + 1)) {
+        if (qjs_bad_int_arg(ctx, argv[var_arg_index + 1], first + var_arg_index + 1)) {
             return JS_EXCEPTION;
         }
         if (JS_ToInt64(ctx, &length, argv[var_arg_index + 1])) {
@@ -114,6 +116,10 @@ static JSValue parse_args(JSContext *ctx, LoadData *data, bool has_field, int ar
     return JS_TRUE;
 }
 
+static JSValue parse_args(JSContext *ctx, LoadData *data, bool has_field, int argc, JSValueConst *argv, LoadFunc func) {
+    return parse_args_from(ctx, data, has_field, argc, argv, func, 0);
+}
+
 static JSValue syscall_load(JSContext *ctx, LoadData *data) {
     int err = 0;
     JSValue ret = JS_EXCEPTION;
@@ -152,6 +158,50 @@ exit:
     }
 }
 
+// The *Into variants write into a caller supplied buffer instead of a new
+// ArrayBuffer: (buffer, bufferOffset, index, source, [field], [offset]). They
+// take a single syscall and return the full length of the item from `offset`,
+// of which min(length, buffer size - bufferOffset) bytes were written. The
+// buffer implies the length, so a trailing length argument is a RangeError.
+static JSValue syscall_load_into(JSContext *ctx, int argc, JSValueConst *argv, bool has_field, LoadFunc func) {
+    uint8_t *buf = NULL;
+    size_t buf_len = 0;
+    int64_t buf_offset = 0;
+    buf = qjs_get_bytes(ctx, argv[0], &buf_len);
+    if (buf == NULL) {
+        return JS_ThrowTypeError(ctx, "Invalid argument: expected ArrayBuffer, TypedArray or DataView at index 0");
+    }
+    if (qjs_bad_int_arg(ctx, argv[1], 1)) {
+        return JS_EXCEPTION;
+    }
+    if (JS_ToInt64(ctx, &buf_offset, argv[1])) {
+        return JS_EXCEPTION;
+    }
+    if (buf_offset < 0 || (uint64_t)buf_offset > buf_len) {
+        return JS_ThrowRangeError(ctx, "bufferOffset is out of the buffer");
+    }
+
+    LoadData data = {0};
+    JSValue ret = parse_args_from(ctx, &data, has_field, argc - 2, argv + 2, func, 2);
+    if (JS_IsException(ret)) {
+        return ret;
+    }
+    // the length argument is implied by the buffer
+    if (data.length != NO_VALUE) {
+        return JS_ThrowRangeError(ctx, "length is implied by the buffer, pass a view of the bytes to load instead");
+    }
+    if (data.offset == NO_VALUE) {
+        data.offset = 0;
+    }
+    uint64_t len = buf_len - buf_offset;
+    int err = func(buf + buf_offset, &len, &data);
+    if (err != 0) {
+        qjs_throw_error(ctx, err, "ckb syscall error");
+        return JS_EXCEPTION;
+    }
+    return JS_NewInt64(ctx, (int64_t)len);
+}
+
 static int _load_tx_hash(void *addr, uint64_t *len, LoadData *data) {
     return ckb_load_tx_hash(addr, len, data->offset);
 }
@@ -286,6 +336,10 @@ static JSValue syscall_load_witness(JSContext *ctx, JSValueConst this_val, int a
     return syscall_load(ctx, &data);
 }
 
+static JSValue syscall_load_witness_into(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return syscall_load_into(ctx, argc, argv, false, _load_witness);
+}
+
 static int _load_cell_data(void *addr, uint64_t *len, LoadData *data) {
     return ckb_load_cell_data(addr, len, data->offset, data->index, data->source);
 }
@@ -299,6 +353,64 @@ static JSValue syscall_load_cell_data(JSContext *ctx, JSValueConst this_val, int
     return syscall_load(ctx, &data);
 }
 
+static JSValue syscall_load_cell_data_into(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return syscall_load_into(ctx, argc, argv, false, _load_cell_data);
+}
+
+// sumUdtAmount(source, [offset]) adds up the little-endian u128 amounts at
+// `offset` (default 0) of the data of all cells in `source`, as sUDT and xUDT
+// store them, and returns the sum as a single BigInt.
+static JSValue syscall_sum_udt_amount(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    int err = 0;
+    int64_t source = 0;
+    int32_t offset = 0;
+    uint64_t sum_lo = 0;
+    uint64_t sum_hi = 0;
+    const char *message = "ckb syscall error";
+
+    CHECK2(!qjs_bad_bigint_arg(ctx, argv[0], 0), ERROR_TEMP);
+    CHECK2(JS_ToInt64Ext(ctx, &source, argv[0]) == 0, ERROR_TEMP);
+    if (!JS_IsUndefined(argv[1])) {
+        CHECK2(!qjs_bad_int_arg(ctx, argv[1], 1), ERROR_TEMP);
+        CHECK2(JS_ToInt32(ctx, &offset, argv[1]) == 0, ERROR_TEMP);
+    }
+    CHECK2(offset >= 0, QJS_ERROR_INVALID_ARGUMENT);
+
+    for (size_t index = 0;; index++) {
+        uint8_t amount[16];
+        uint64_t len = sizeof(amount);
+        err = ckb_load_cell_data(amount, &len, offset, index, source);
+        if (err == CKB_INDEX_OUT_OF_BOUND) {
+            err = 0;
+            break;
+        }
+        CHECK(err);
+        if (len < sizeof(amount)) {
+            message = "cell data is too short for a UDT amount";
+            err = CKB_LENGTH_NOT_ENOUGH;
+            goto exit;
+        }
+        uint64_t lo, hi;
+        memcpy(&lo, amount, 8);
+        memcpy(&hi, amount + 8, 8);
+        sum_lo += lo;
+        uint64_t carry = sum_lo < lo;
+        if (__builtin_add_overflow(sum_hi, hi, &sum_hi) || __builtin_add_overflow(sum_hi, carry, &sum_hi)) {
+            message = "UDT amount overflow";
+            err = QJS_ERROR_OVERFLOW;
+            goto exit;
+        }
+    }
+exit:
+    if (err != 0) {
+        if (err != ERROR_TEMP) {
+            qjs_throw_error(ctx, err, message);
+        }
+        return JS_EXCEPTION;
+    }
+    return JS_NewBigUint128(ctx, sum_lo, sum_hi);
+}
+
 static int _load_cell_by_field(void *addr, uint64_t *len, LoadData *data) {
     return ckb_load_cell_by_field(addr, len, data->offset, data->index, data->source, data->field);
 }
@@ -312,6 +424,87 @@ static JSValue syscall_load_cell_by_field(JSContext *ctx, JSValueConst this_val,
     return syscall_load(ctx, &data);
 }
 
+// loadCellsByField(source, field, [start], [count]) loads `field` of the cells
+// from `start` until CKB_INDEX_OUT_OF_BOUND (or `count` cells) in one call. It
+// returns {data, offsets}: the fields packed into one ArrayBuffer and a
+// Uint32Array of count + 1 entries, item i being data[offsets[i], offsets[i + 1]).
+// A missing item (e.g. the type of a cell without one) is empty.
+static JSValue syscall_load_cells_by_field(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    int err = 0;
+    JSValue ret = JS_EXCEPTION;
+    int64_t source = 0;
+    int32_t field = 0;
+    int32_t start = 0;
+    int32_t count = -1;
+    DynBuf data_buf, offsets_buf;
+    qjs_dbuf_init(ctx, &data_buf);
+    qjs_dbuf_init(ctx, &offsets_buf);
+
+    CHECK2(!qjs_bad_bigint_arg(ctx, argv[0], 0), ERROR_TEMP);
+    CHECK2(JS_ToInt64Ext(ctx, &source, argv[0]) == 0, ERROR_TEMP);
+    CHECK2(!qjs_bad_int_arg(ctx, argv[1], 1), ERROR_TEMP);
+    CHECK2(JS_ToInt32(ctx, &field, argv[1]) == 0, ERROR_TEMP);
+    if (!JS_IsUndefined(argv[2])) {
+        CHECK2(!qjs_bad_int_arg(ctx, argv[2], 2), ERROR_TEMP);
+        CHECK2(JS_ToInt32(ctx, &start, argv[2]) == 0, ERROR_TEMP);
+    }
+    if (!JS_IsUndefined(argv[3])) {
+        CHECK2(!qjs_bad_int_arg(ctx, argv[3], 3), ERROR_TEMP);
+        CHECK2(JS_ToInt32(ctx, &count, argv[3]) == 0, ERROR_TEMP);
+    }
+    CHECK2(start >= 0, QJS_ERROR_INVALID_ARGUMENT);
+
+    CHECK2(dbuf_realloc(&data_buf, 64) == 0, QJS_ERROR_MEMORY_ALLOCATION);
+    CHECK2(dbuf_put_u32(&offsets_buf, 0) == 0, QJS_ERROR_MEMORY_ALLOCATION);
+    for (size_t index = start; count < 0 || index < (size_t)start + count; index++) {
+        // load into the free space first, only fetching the rest of an item
+        // that does not fit after growing the buffer
+        CHECK2(dbuf_realloc(&data_buf, data_buf.size + 64) == 0, QJS_ERROR_MEMORY_ALLOCATION);
+        uint64_t avail = data_buf.allocated_size - data_buf.size;
+        uint64_t len = avail;
+        err = ckb_load_cell_by_field(data_buf.buf + data_buf.size, &len, 0, index, source, field);
+        if (err == CKB_INDEX_OUT_OF_BOUND) {
+            err = 0;
+            break;
+        }
+        if (err == CKB_ITEM_MISSING) {
+            err = 0;
+            len = 0;
+        }
+        CHECK(err);
+        if (len > avail) {
+            CHECK2(dbuf_realloc(&data_buf, data_buf.size + len) == 0, QJS_ERROR_MEMORY_ALLOCATION);
+            uint64_t rest = len - avail;
+            err = ckb_load_cell_by_field(data_buf.buf + data_buf.size + avail, &rest, avail, index, source, field);
+            CHECK(err);
+        }
+        data_buf.size += len;
+        CHECK2(data_buf.size <= UINT32_MAX, QJS_ERROR_MEMORY_ALLOCATION);
+        CHECK2(dbuf_put_u32(&offsets_buf, (uint32_t)data_buf.size) == 0, QJS_ERROR_MEMORY_ALLOCATION);
+    }
+
+    ret = JS_NewObject(ctx);
+    CHECK2(!JS_IsException(ret), ERROR_TEMP);
+    JSValue data = JS_NewArrayBuffer(ctx, data_buf.buf, data_buf.size, my_free, data_buf.buf, false);
+    CHECK2(!JS_IsException(data), ERROR_TEMP);
+    data_buf.buf = NULL;
+    JS_SetPropertyStr(ctx, ret, "data", data);
+    JSValue offsets = qjs_create_uint32_array(ctx, (uint32_t *)offsets_buf.buf, offsets_buf.size / sizeof(uint32_t));
+    CHECK2(!JS_IsException(offsets), ERROR_TEMP);
+    JS_SetPropertyStr(ctx, ret, "offsets", offsets);
+exit:
+    dbuf_free(&data_buf);
+    dbuf_free(&offsets_buf);
+    if (err != 0) {
+        JS_FreeValue(ctx, ret);
+        if (err != ERROR_TEMP) {
+            qjs_throw_error(ctx, err, "ckb syscall error");
+        }
+        return JS_EXCEPTION;
+    }
+    return ret;
+}
+
 static int _load_header_by_field(void *addr, uint64_t *len, LoadData *data) {
     return ckb_load_header_by_field(addr, len, data->offset, data->index, data->source, data->field);
 }
@@ -358,7 +551,7 @@ static JSValue syscall_exec_cell(JSContext *ctx, JSValueConst this_value, int ar
     const char *passed_argv[256] = {0};
     uint8_t code_hash[32];
 
-    uint8_t *p = JS_GetArrayBuffer(ctx, &code_hash_len, argv[0]);
+    uint8_t *p = qjs_get_bytes(ctx, argv[0], &code_hash_len);
     if (code_hash_len != 32 || p == NULL) {
         return JS_ThrowTypeError(ctx, "invalid code_hash format");
     }
@@ -435,7 +628,7 @@ static JSValue syscall_spawn_internal(JSContext *ctx, JSValueConst this_value, i
     int64_t source = 0;
     uint64_t place = 0;
     if (via_code_hash) {
-        uint8_t *p = JS_GetArrayBuffer(ctx, &code_hash_len, argv[0]);
+        uint8_t *p = qjs_get_bytes(ctx, argv[0], &code_hash_len);
         if (code_hash_len != 32 || p == NULL) {
             return JS_ThrowTypeError(ctx, "invalid code_hash format");
         }
@@ -605,7 +798,7 @@ static JSValue syscall_write(JSContext *ctx, JSValueConst this_value, int argc,
     CHECK(err);
     fd = (uint64_t)u32;
     size_t length = 0;
-    uint8_t *content = JS_GetArrayBuffer(ctx, &length, argv[1]);
+    uint8_t *content = qjs_get_bytes(ctx, argv[1], &length);
     CHECK2(content != NULL, QJS_ERROR_GENERIC);
     err = ckb_write(fd, content, &length);
     CHECK(err);
@@ -762,51 +955,45 @@ static JSValue js_eval_script(JSContext *ctx, JSValueConst this_val, int argc, J
     return ret;
 }
 
-static JSValue js_load_file(JSContext *ctx, JSValueConst _this_val, int argc, JSValueConst *argv) {
-    uint8_t *buf = NULL;
+// Look up a file of the mounted file system for loadFile and loadJsScript. The
+// file system must have been mounted before, so this is a hash lookup: the code
+// cell isn't loaded again. The file is borrowed, see ckb_release_file.
+static int get_script_file(JSContext *ctx, JSValueConst name, FSFile **file) {
     const char *filename = NULL;
-    JSValue ret = JS_EXCEPTION;
-    size_t buf_len = 0;
     int err = 0;
 
-    filename = JS_ToCString(ctx, argv[0]);
-    CHECK2(filename != NULL, QJS_ERROR_GENERIC);
-
     size_t index = 0;
-    bool use_filesystem = false;
-    err = qjs_load_cell_code_info(&buf_len, &index, &use_filesystem);
+    uint16_t flags = 0;
+    err = qjs_load_cell_code_info(&index, &flags);
     CHECK(err);
+    if (!(flags & QJS_FLAG_FILESYSTEM)) {
+        JS_ThrowInternalError(ctx, "loadFile fail: filesystem is disabled.");
+        return QJS_ERROR_EXCEPTION;
+    }
 
-    buf = js_malloc(ctx, buf_len + 1);
-    CHECK2(buf != NULL, QJS_ERROR_GENERIC);
-
-    err = qjs_load_cell_code(buf_len, index, buf);
+    filename = JS_ToCString(ctx, name);
+    CHECK2(filename != NULL, QJS_ERROR_GENERIC);
+    err = ckb_get_file(filename, file);
     CHECK(err);
 
-    if (use_filesystem) {
-        // don't need to load file system for a single file.
-        // it should be mounted or initialized before.
-        FSFile *file_handler = NULL;
-        err = ckb_get_file(filename, &file_handler);
-        CHECK(err);
-        ret = JS_NewStringLen(ctx, file_handler->content, file_handler->size);
-    } else {
-        ret = JS_ThrowInternalError(ctx, "loadFile fail: filesystem is disabled.");
-    }
-
 exit:
-    if (buf) {
-        js_free(ctx, buf);
-    }
     if (filename) {
         JS_FreeCString(ctx, filename);
     }
-    if (err) {
+    if (err && err != QJS_ERROR_EXCEPTION) {
         qjs_throw_error(ctx, err, "load_file operation failed with error");
+    }
+    return err;
+}
+
+static JSValue js_load_file(JSContext *ctx, JSValueConst _this_val, int argc, JSValueConst *argv) {
+    FSFile *file = NULL;
+    if (get_script_file(ctx, argv[0], &file) != 0) {
         return JS_EXCEPTION;
-    } else {
-        return ret;
     }
+    JSValue ret = JS_NewStringLen(ctx, file->content, file->size);
+    ckb_release_file(file);
+    return ret;
 }
 
 static JSValue js_load_script(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
@@ -817,14 +1004,13 @@ static JSValue js_load_script(JSContext *ctx, JSValueConst this_val, int argc, J
         enable_module = JS_ToBool(ctx, argv[1]);
     }
 
-    JSValue ret = js_load_file(ctx, this_val, argc, argv);
-    if (JS_IsException(ret)) return ret;
-
-    size_t len = 0;
-    const char *str = JS_ToCStringLen(ctx, &len, ret);
-    JS_FreeValue(ctx, ret);
-    ret = qjs_eval_script(ctx, str, len, enable_module);
-    JS_FreeCString(ctx, str);
+    // evaluated straight from the file system, without going through a JS string
+    FSFile *file = NULL;
+    if (get_script_file(ctx, argv[0], &file) != 0) {
+        return JS_EXCEPTION;
+    }
+    JSValue ret = qjs_eval_script(ctx, file->content, file->size, enable_module);
+    ckb_release_file(file);
     return ret;
 }
 
@@ -851,8 +1037,12 @@ static const JSCFunctionListEntry js_ckb_funcs[] = {
     JS_CFUNC_DEF("loadInput", 4, syscall_load_input),
     JS_CFUNC_DEF("loadHeader", 4, syscall_load_header),
     JS_CFUNC_DEF("loadWitness", 4, syscall_load_witness),
+    JS_CFUNC_DEF("loadWitnessInto", 5, syscall_load_witness_into),
     JS_CFUNC_DEF("loadCellData", 4, syscall_load_cell_data),
+    JS_CFUNC_DEF("loadCellDataInto", 5, syscall_load_cell_data_into),
+    JS_CFUNC_DEF("sumUdtAmount", 2, syscall_sum_udt_amount),
     JS_CFUNC_DEF("loadCellByField", 5, syscall_load_cell_by_field),
+    JS_CFUNC_DEF("loadCellsByField", 4, syscall_load_cells_by_field),
     JS_CFUNC_DEF("loadHeaderByField", 5, syscall_load_header_by_field),
     JS_CFUNC_DEF("loadInputByField", 5, syscall_load_input_by_field),
     JS_CFUNC_DEF("vmVersion", 0, syscall_vm_version),
@@ -929,17 +1119,28 @@ int qjs_init_module_ckb(JSContext *ctx, JSModuleDef *m) {
 #define SCRIPT_SIZE 32768
 #define JS_LOADER_ARGS_SIZE 2
 #define BLAKE2B_BLOCK_SIZE 32
-
-int qjs_load_cell_code_info_explicit(size_t *buf_size, size_t *index, const uint8_t *code_hash, uint8_t hash_type) {
+// Reserved for a code cell up front, which covers most of them in one load.
+// A larger cell extends the region, see qjs_load_cell_code.
+#define CODE_REGION_MAX_SIZE (512 * 1024)
+#define CODE_REGION_ALIGN 4096
+
+// The code cell is loaded once into a page-aligned region carved directly from
+// the program break. The file system and eval_buf read from it in place.
+static uint8_t *g_code_region = NULL;
+static size_t g_code_region_size = 0;
+static size_t g_code_region_index = NO_VALUE;
+
+// The current script and its cell deps can't change during a run, so the
+// script args are parsed and the code cell is searched only once.
+static bool g_cell_code_info_loaded = false;
+static size_t g_cell_code_info_index = 0;
+static uint16_t g_cell_code_info_flags = 0;
+
+int qjs_load_cell_code_info_explicit(size_t *index, const uint8_t *code_hash, uint8_t hash_type) {
     int err = 0;
     *index = 0;
     err = ckb_look_for_dep_with_hash2(code_hash, hash_type, index);
     CHECK(err);
-
-    *buf_size = 0;
-    err = ckb_load_cell_data(NULL, buf_size, 0, *index, CKB_SOURCE_CELL_DEP);
-    CHECK(err);
-    CHECK2(*buf_size > 0, QJS_ERROR_FILE_READ);
 exit:
     if (err) {
         err = QJS_ERROR_LOAD_CODE;
@@ -947,7 +1148,13 @@ exit:
     return err;
 }
 
-int qjs_load_cell_code_info(size_t *buf_size, size_t *index, bool *use_filesystem) {
+int qjs_load_cell_code_info(size_t *index, uint16_t *flags) {
+    if (g_cell_code_info_loaded) {
+        *index = g_cell_code_info_index;
+        *flags = g_cell_code_info_flags;
+        return 0;
+    }
+
     int err = 0;
     unsigned char script[SCRIPT_SIZE];
     uint64_t len = SCRIPT_SIZE;
@@ -973,8 +1180,7 @@ int qjs_load_cell_code_info(size_t *buf_size, size_t *index, bool *use_filesyste
     // <js loader args, 2 bytes> <code hash of js code, 32 bytes>
     // <hash type of js code, 1 byte>
     CHECK2(args_bytes_seg.size >= JS_LOADER_ARGS_SIZE + BLAKE2B_BLOCK_SIZE + 1, QJS_ERROR_INVALID_SCRIPT_ARGS);
-    uint16_t js_loader_args = *(uint16_t *)args_bytes_seg.ptr;
-    *use_filesystem = js_loader_args & 0x1;
+    *flags = *(uint16_t *)args_bytes_seg.ptr;
 
     uint8_t *code_hash = args_bytes_seg.ptr + JS_LOADER_ARGS_SIZE;
     uint8_t hash_type = *(args_bytes_seg.ptr + JS_LOADER_ARGS_SIZE + BLAKE2B_BLOCK_SIZE);
@@ -983,19 +1189,120 @@ int qjs_load_cell_code_info(size_t *buf_size, size_t *index, bool *use_filesyste
     err = ckb_look_for_dep_with_hash2(code_hash, hash_type, index);
     CHECK(err);
 
-    *buf_size = 0;
-    err = ckb_load_cell_data(NULL, buf_size, 0, *index, CKB_SOURCE_CELL_DEP);
-    CHECK(err);
-    CHECK2(*buf_size > 0, QJS_ERROR_FILE_READ);
+    g_cell_code_info_index = *index;
+    g_cell_code_info_flags = *flags;
+    g_cell_code_info_loaded = true;
 exit:
     return err;
 }
 
-int qjs_load_cell_code(size_t buf_size, size_t index, uint8_t *buf) {
-    int ret = ckb_load_cell_data(buf, &buf_size, 0, index, CKB_SOURCE_CELL_DEP);
-    if (ret) {
-        printf("Error while loading cell data: %d\n", ret);
-        return ret;
+// Reserve CODE_REGION_MAX_SIZE at the program break so that most cells load
+// in one pass: no size probe and no extra copy.
+static uint8_t *reserve_code_region(void) {
+    uint8_t *region = _sbrk(CODE_REGION_MAX_SIZE);
+    if (region == (void *)-1) {
+        printf("Error while reserving code region\n");
+        return NULL;
+    }
+    return region;
+}
+
+// Move the break to the page after the content: hand the unused tail of the
+// reservation back, or extend it for a cell larger than the reservation. The
+// region stays contiguous either way since nothing else takes from the break
+// in between. Returns false if the break can't be extended.
+static size_t code_region_committed(size_t len) {
+    return (len + 1 + CODE_REGION_ALIGN - 1) & ~(size_t)(CODE_REGION_ALIGN - 1);
+}
+
+static bool commit_code_region(uint8_t *region, size_t len, size_t index) {
+    if (_sbrk((uintptr_t)code_region_committed(len) - CODE_REGION_MAX_SIZE) == (void *)-1) {
+        return false;
+    }
+    region[len] = 0;
+
+    g_code_region = region;
+    g_code_region_size = len;
+    g_code_region_index = index;
+    malloc_set_reserved(code_region_committed(len));
+    return true;
+}
+
+int qjs_load_cell_code(size_t index, uint8_t **buf, size_t *buf_size) {
+    int err = 0;
+    if (g_code_region != NULL && g_code_region_index == index) {
+        *buf = g_code_region;
+        *buf_size = g_code_region_size;
+        return 0;
     }
+    uint8_t *region = reserve_code_region();
+    if (region == NULL) {
+        return QJS_ERROR_MEMORY_ALLOCATION;
+    }
+    // keep one byte for the trailing zero required by QuickJS
+    uint64_t len = CODE_REGION_MAX_SIZE - 1;
+    err = ckb_load_cell_data(region, &len, 0, index, CKB_SOURCE_CELL_DEP);
+    if (err) {
+        printf("Error while loading cell data: %d\n", err);
+        _sbrk(-(uintptr_t)CODE_REGION_MAX_SIZE);
+        return err;
+    }
+    if (len == 0) {
+        _sbrk(-(uintptr_t)CODE_REGION_MAX_SIZE);
+        return QJS_ERROR_FILE_READ;
+    }
+    if (!commit_code_region(region, len, index)) {
+        printf("Error while extending code region\n");
+        _sbrk(-(uintptr_t)CODE_REGION_MAX_SIZE);
+        return QJS_ERROR_MEMORY_ALLOCATION;
+    }
+    // The first load filled the reservation and reported the full size, the
+    // region now covers it: load only the rest
+    if (len > CODE_REGION_MAX_SIZE - 1) {
+        uint64_t rest = len - (CODE_REGION_MAX_SIZE - 1);
+        err = ckb_load_cell_data(region + CODE_REGION_MAX_SIZE - 1, &rest, CODE_REGION_MAX_SIZE - 1, index,
+                                 CKB_SOURCE_CELL_DEP);
+        if (err || rest != len - (CODE_REGION_MAX_SIZE - 1)) {
+            printf("Error while loading cell data: %d\n", err);
+            _sbrk(-(uintptr_t)code_region_committed(len));
+            malloc_set_reserved(0);
+            g_code_region = NULL;
+            g_code_region_size = 0;
+            g_code_region_index = NO_VALUE;
+            return err ? err : QJS_ERROR_FILE_READ;
+        }
+    }
+    *buf = region;
+    *buf_size = len;
     return 0;
 }
+
+// The local file syscall can't read from an offset, so local files (testing
+// only) are limited to CODE_REGION_MAX_SIZE - 1 bytes.
+int qjs_load_local_code(uint8_t **buf, size_t *buf_size) {
+    uint8_t *region = reserve_code_region();
+    if (region == NULL) {
+        return QJS_ERROR_MEMORY_ALLOCATION;
+    }
+    int count = qjs_read_local_file((char *)region, CODE_REGION_MAX_SIZE);
+    if (count < 0 || count == CODE_REGION_MAX_SIZE) {
+        _sbrk(-(uintptr_t)CODE_REGION_MAX_SIZE);
+        if (count == CODE_REGION_MAX_SIZE) {
+            printf("Error while reading from file: file too large\n");
+            return QJS_ERROR_FILE_TOO_LARGE;
+        } else {
+            printf("Error while reading from file: %d\n", count);
+            return QJS_ERROR_FILE_READ;
+        }
+    }
+    commit_code_region(region, (size_t)count, NO_VALUE);
+    *buf = region;
+    *buf_size = (size_t)count;
+    return 0;
+}
+
+bool qjs_is_code_region(const void *ptr, size_t len) {
+    const uint8_t *p = ptr;
+    return g_code_region != NULL && p >= g_code_region && len <= g_code_region_size &&
+           (size_t)(p - g_code_region) <= g_code_region_size - len;
+}
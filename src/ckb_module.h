@@ -29,8 +29,28 @@ JSValue qjs_throw_error(JSContext *ctx, int32_t error_code, const char *message)
 JSValue qjs_eval_script(JSContext *ctx, const char *str, int len, bool enable_module);
 
 int qjs_read_local_file(char *buf, int size);
-int qjs_load_cell_code_info_explicit(size_t *buf_size, size_t *index, const uint8_t *code_hash, uint8_t hash_type);
-int qjs_load_cell_code_info(size_t *buf_size, size_t *index, bool *use_filesystem);
-int qjs_load_cell_code(size_t buf_size, size_t index, uint8_t *buf);
+int qjs_load_cell_code_info_explicit(size_t *index, const uint8_t *code_hash, uint8_t hash_type);
+// ckb-js-vm flags, the first 2 bytes of the script args
+#define QJS_FLAG_FILESYSTEM 0x01
+#define QJS_FLAG_LAZY_MODULES 0x02
+#define QJS_FLAG_ARENA 0x04
+int qjs_load_cell_code_info(size_t *index, uint16_t *flags);
+/**
+ * Loads the code cell at `index` of the cell deps into a page-aligned region
+ * reserved at the program break. The content is followed by a trailing zero
+ * and stays valid for the lifetime of the VM; loading the same cell again
+ * returns the same region without any syscall.
+ */
+int qjs_load_cell_code(size_t index, uint8_t **buf, size_t *buf_size);
+/**
+ * Same as qjs_load_cell_code, but the content is read from the local file
+ * given to ckb-debugger (`--read-file`). For testing only.
+ */
+int qjs_load_local_code(uint8_t **buf, size_t *buf_size);
+/**
+ * Returns true if [ptr, ptr + len) lies in the code region. Such memory is
+ * writable and never freed, so it can be used in place (e.g. by snapshots).
+ */
+bool qjs_is_code_region(const void *ptr, size_t len);
 
 #endif  // _CKB_MODULE_H_
@@ -5,9 +5,257 @@
 #include "ckb_keccak256.h"
 #include "blake2b.h"
 #include "ripemd160.h"
+#include "ckb_syscalls.h"
+#include "ckb_module.h"
+#include "utils.h"
 #include "qjs.h"
 
 #define BLAKE2B_HASH_SIZE 32
+// Data hashed from syscalls is loaded through a stack buffer of this size, so
+// that hashing a witness or cell data never allocates it in JS.
+#define SYSCALL_CHUNK_SIZE 1024
+
+// The `kind` argument of updateFromSyscall
+enum {
+    HASH_LOAD_WITNESS = 0,
+    HASH_LOAD_CELL_DATA = 1,
+    HASH_LOAD_CELL = 2,
+    HASH_LOAD_INPUT = 3,
+    HASH_LOAD_HEADER = 4,
+    HASH_LOAD_TRANSACTION = 5,
+    HASH_LOAD_SCRIPT = 6,
+};
+
+static const struct {
+    const char *name;
+    int kind;
+} syscall_kinds[] = {
+    {"LOAD_WITNESS", HASH_LOAD_WITNESS},
+    {"LOAD_CELL_DATA", HASH_LOAD_CELL_DATA},
+    {"LOAD_CELL", HASH_LOAD_CELL},
+    {"LOAD_INPUT", HASH_LOAD_INPUT},
+    {"LOAD_HEADER", HASH_LOAD_HEADER},
+    {"LOAD_TRANSACTION", HASH_LOAD_TRANSACTION},
+    {"LOAD_SCRIPT", HASH_LOAD_SCRIPT},
+};
+
+typedef void (*HashUpdateFunc)(void *state, const uint8_t *data, size_t len);
+
+static int load_by_kind(int kind, void *addr, uint64_t *len, size_t offset, size_t index, size_t source) {
+    switch (kind) {
+        case HASH_LOAD_WITNESS:
+            return ckb_load_witness(addr, len, offset, index, source);
+        case HASH_LOAD_CELL_DATA:
+            return ckb_load_cell_data(addr, len, offset, index, source);
+        case HASH_LOAD_CELL:
+            return ckb_load_cell(addr, len, offset, index, source);
+        case HASH_LOAD_INPUT:
+            return ckb_load_input(addr, len, offset, index, source);
+        case HASH_LOAD_HEADER:
+            return ckb_load_header(addr, len, offset, index, source);
+        case HASH_LOAD_TRANSACTION:
+            return ckb_load_transaction(addr, len, offset);
+        case HASH_LOAD_SCRIPT:
+            return ckb_load_script(addr, len, offset);
+        default:
+            return QJS_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+// Feeds `length` bytes (NO_VALUE for all) from `offset` of the item loaded by
+// `kind` into the hash state, one chunk per syscall. The number of bytes hashed
+// is stored in `hashed`.
+static int hash_from_syscall(void *state, HashUpdateFunc update, int kind, size_t index, size_t source,
+                             size_t offset, size_t length, size_t *hashed) {
+    uint8_t chunk[SYSCALL_CHUNK_SIZE];
+    size_t total = 0;
+    while (total < length) {
+        uint64_t len = sizeof(chunk);
+        int err = load_by_kind(kind, chunk, &len, offset + total, index, source);
+        if (err != 0) {
+            return err;
+        }
+        // len is what is left of the item from the current offset
+        size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+        if (n > length - total) {
+            n = length - total;
+        }
+        update(state, chunk, n);
+        total += n;
+        if (len <= sizeof(chunk)) {
+            break;
+        }
+    }
+    *hashed = total;
+    return 0;
+}
+
+// Arguments: index, source, [offset], [length]
+static int parse_syscall_args(JSContext *ctx, int argc, JSValueConst *argv, int first, size_t *index,
+                              size_t *source, size_t *offset, size_t *length) {
+    int32_t i32 = 0;
+    int64_t i64 = 0;
+    if (qjs_bad_int_arg(ctx, argv[0], first) || JS_ToInt32(ctx, &i32, argv[0])) {
+        return -1;
+    }
+    if (i32 < 0) {
+        JS_ThrowRangeError(ctx, "index must not be negative");
+        return -1;
+    }
+    *index = i32;
+    if (qjs_bad_bigint_arg(ctx, argv[1], first + 1) || JS_ToInt64Ext(ctx, &i64, argv[1])) {
+        return -1;
+    }
+    *source = i64;
+    *offset = 0;
+    *length = NO_VALUE;
+    if (argc > 2 && !JS_IsUndefined(argv[2])) {
+        if (qjs_bad_int_arg(ctx, argv[2], first + 2) || JS_ToInt32(ctx, &i32, argv[2])) {
+            return -1;
+        }
+        if (i32 < 0) {
+            JS_ThrowRangeError(ctx, "offset must not be negative");
+            return -1;
+        }
+        *offset = i32;
+    }
+    if (argc > 3 && !JS_IsUndefined(argv[3])) {
+        if (qjs_bad_int_arg(ctx, argv[3], first + 3) || JS_ToInt32(ctx, &i32, argv[3])) {
+            return -1;
+        }
+        if (i32 < 0) {
+            JS_ThrowRangeError(ctx, "length must not be negative");
+            return -1;
+        }
+        *length = i32;
+    }
+    return 0;
+}
+
+// The data items of one update() call: the arguments, with the elements of
+// array arguments in their place
+typedef struct {
+    JSValue *values;
+    uint32_t count;
+    uint32_t capacity;
+    JSValue inline_values[8];
+} HashItems;
+
+// Takes ownership of val
+static int hash_items_push(JSContext *ctx, HashItems *items, JSValue val) {
+    if (items->count == items->capacity) {
+        uint32_t capacity = items->capacity * 2;
+        JSValue *values = js_malloc(ctx, capacity * sizeof(JSValue));
+        if (!values) {
+            JS_FreeValue(ctx, val);
+            return -1;
+        }
+        memcpy(values, items->values, items->count * sizeof(JSValue));
+        if (items->values != items->inline_values) {
+            js_free(ctx, items->values);
+        }
+        items->values = values;
+        items->capacity = capacity;
+    }
+    items->values[items->count++] = val;
+    return 0;
+}
+
+static int hash_items_push_array(JSContext *ctx, HashItems *items, JSValueConst val) {
+    uint32_t length = 0;
+    JSValue length_val = JS_GetPropertyStr(ctx, val, "length");
+    int err = JS_ToUint32(ctx, &length, length_val);
+    JS_FreeValue(ctx, length_val);
+    if (err) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        JSValue item = JS_GetPropertyUint32(ctx, val, i);
+        if (JS_IsException(item)) {
+            return -1;
+        }
+        int is_array = JS_IsArray(ctx, item);
+        if (is_array) {
+            JS_FreeValue(ctx, item);
+            if (is_array > 0) {
+                JS_ThrowTypeError(ctx, "invalid data: nested array");
+            }
+            return -1;
+        }
+        if (hash_items_push(ctx, items, item)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// update(...data) of all hashers: every argument is an ArrayBuffer, a view
+// (TypedArray or DataView) or an array of those, all hashed in a single call.
+// Nothing is hashed unless every item is valid, so a caller catching the
+// TypeError keeps the hasher state it had.
+static int hash_update_values(JSContext *ctx, void *state, HashUpdateFunc update, int argc, JSValueConst *argv) {
+    if (argc == 0) {
+        JS_ThrowTypeError(ctx, "invalid data");
+        return -1;
+    }
+    HashItems items;
+    items.values = items.inline_values;
+    items.count = 0;
+    items.capacity = countof(items.inline_values);
+    int err = -1;
+    for (int i = 0; i < argc; i++) {
+        int is_array = JS_IsArray(ctx, argv[i]);
+        if (is_array < 0) goto exit;
+        if (is_array ? hash_items_push_array(ctx, &items, argv[i])
+                     : hash_items_push(ctx, &items, JS_DupValue(ctx, argv[i]))) {
+            goto exit;
+        }
+    }
+    // No JS code runs from here on, so no buffer can be detached between
+    // checking the items and hashing them
+    size_t data_len = 0;
+    for (uint32_t i = 0; i < items.count; i++) {
+        if (!qjs_get_bytes(ctx, items.values[i], &data_len)) {
+            JS_ThrowTypeError(ctx, "invalid data");
+            goto exit;
+        }
+    }
+    for (uint32_t i = 0; i < items.count; i++) {
+        uint8_t *data = qjs_get_bytes(ctx, items.values[i], &data_len);
+        update(state, data, data_len);
+    }
+    err = 0;
+exit:
+    for (uint32_t i = 0; i < items.count; i++) {
+        JS_FreeValue(ctx, items.values[i]);
+    }
+    if (items.values != items.inline_values) {
+        js_free(ctx, items.values);
+    }
+    return err;
+}
+
+// updateFromSyscall(kind, index, source, [offset], [length]) of all hashers,
+// returns the number of bytes hashed
+static JSValue hash_update_from_syscall(JSContext *ctx, void *state, HashUpdateFunc update, int argc,
+                                        JSValueConst *argv) {
+    int32_t kind = 0;
+    size_t index, source, offset, length, hashed = 0;
+    if (qjs_bad_int_arg(ctx, argv[0], 0) || JS_ToInt32(ctx, &kind, argv[0])) {
+        return JS_EXCEPTION;
+    }
+    if (kind < HASH_LOAD_WITNESS || kind > HASH_LOAD_SCRIPT) {
+        return JS_ThrowRangeError(ctx, "invalid syscall kind: %d", kind);
+    }
+    if (parse_syscall_args(ctx, argc - 1, argv + 1, 1, &index, &source, &offset, &length)) {
+        return JS_EXCEPTION;
+    }
+    int err = hash_from_syscall(state, update, kind, index, source, offset, length, &hashed);
+    if (err != 0) {
+        return qjs_throw_error(ctx, err, "ckb syscall error");
+    }
+    return JS_NewInt64(ctx, (int64_t)hashed);
+}
 
 static int js_blake2b_init(blake2b_state *S, size_t outlen, char personal[BLAKE2B_PERSONALBYTES]) {
     blake2b_param P[1];
@@ -78,19 +326,16 @@ fail:
     return JS_EXCEPTION;
 }
 
+static void sha256_update_func(void *state, const uint8_t *data, size_t len) { sha256_update(state, data, len); }
+
 // Method definitions for Sha256 prototype
 static JSValue js_sha256_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
-    size_t data_len;
-    uint8_t *data;
     SHA256_CTX *hash;
 
     hash = JS_GetOpaque2(ctx, this_val, js_sha256_class_id);
     if (!hash) return JS_EXCEPTION;
 
-    data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
-    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
-
-    sha256_update(hash, data, data_len);
+    if (hash_update_values(ctx, hash, sha256_update_func, argc, argv)) return JS_EXCEPTION;
     return JS_UNDEFINED;
 }
 
@@ -108,8 +353,15 @@ static JSValue js_sha256_finalize(JSContext *ctx, JSValueConst this_val, int arg
     return JS_NewArrayBuffer(ctx, output, SHA256_BLOCK_SIZE, free_hash_context, NULL, false);
 }
 
+static JSValue js_sha256_update_from_syscall(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    SHA256_CTX *hash = JS_GetOpaque2(ctx, this_val, js_sha256_class_id);
+    if (!hash) return JS_EXCEPTION;
+    return hash_update_from_syscall(ctx, hash, sha256_update_func, argc, argv);
+}
+
 static const JSCFunctionListEntry js_sha256_proto_funcs[] = {
     JS_CFUNC_DEF("update", 1, js_sha256_write),
+    JS_CFUNC_DEF("updateFromSyscall", 5, js_sha256_update_from_syscall),
     JS_CFUNC_DEF("finalize", 0, js_sha256_finalize),
 };
 
@@ -155,19 +407,24 @@ fail:
     return JS_EXCEPTION;
 }
 
+// keccak_update takes a 16-bit size
+static void keccak256_update_func(void *state, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        uint16_t n = len > 0x8000 ? 0x8000 : (uint16_t)len;
+        keccak_update(state, data, n);
+        data += n;
+        len -= n;
+    }
+}
+
 // Method definitions for Keccak256 prototype
 static JSValue js_keccak256_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
-    size_t data_len;
-    uint8_t *data;
     SHA3_CTX *hash;
 
     hash = JS_GetOpaque2(ctx, this_val, js_keccak256_class_id);
     if (!hash) return JS_EXCEPTION;
 
-    data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
-    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
-
-    keccak_update(hash, data, data_len);
+    if (hash_update_values(ctx, hash, keccak256_update_func, argc, argv)) return JS_EXCEPTION;
     return JS_UNDEFINED;
 }
 
@@ -186,8 +443,15 @@ static JSValue js_keccak256_finalize(JSContext *ctx, JSValueConst this_val, int
     return JS_NewArrayBuffer(ctx, output, KECCAK256_SIZE, free_hash_context, NULL, false);
 }
 
+static JSValue js_keccak256_update_from_syscall(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    SHA3_CTX *hash = JS_GetOpaque2(ctx, this_val, js_keccak256_class_id);
+    if (!hash) return JS_EXCEPTION;
+    return hash_update_from_syscall(ctx, hash, keccak256_update_func, argc, argv);
+}
+
 static const JSCFunctionListEntry js_keccak256_proto_funcs[] = {
     JS_CFUNC_DEF("update", 1, js_keccak256_write),
+    JS_CFUNC_DEF("updateFromSyscall", 5, js_keccak256_update_from_syscall),
     JS_CFUNC_DEF("finalize", 0, js_keccak256_finalize),
 };
 
@@ -265,19 +529,16 @@ fail:
     return JS_EXCEPTION;
 }
 
+static void blake2b_update_func(void *state, const uint8_t *data, size_t len) { blake2b_update(state, data, len); }
+
 // Method definitions for Blake2b prototype
 static JSValue js_blake2b_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
-    size_t data_len;
-    uint8_t *data;
     blake2b_state *hash;
 
     hash = JS_GetOpaque2(ctx, this_val, js_blake2b_class_id);
     if (!hash) return JS_EXCEPTION;
 
-    data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
-    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
-
-    blake2b_update(hash, data, data_len);
+    if (hash_update_values(ctx, hash, blake2b_update_func, argc, argv)) return JS_EXCEPTION;
     return JS_UNDEFINED;
 }
 
@@ -295,8 +556,15 @@ static JSValue js_blake2b_finalize(JSContext *ctx, JSValueConst this_val, int ar
     return JS_NewArrayBuffer(ctx, output, BLAKE2B_HASH_SIZE, free_hash_context, NULL, false);
 }
 
+static JSValue js_blake2b_update_from_syscall(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    blake2b_state *hash = JS_GetOpaque2(ctx, this_val, js_blake2b_class_id);
+    if (!hash) return JS_EXCEPTION;
+    return hash_update_from_syscall(ctx, hash, blake2b_update_func, argc, argv);
+}
+
 static const JSCFunctionListEntry js_blake2b_proto_funcs[] = {
     JS_CFUNC_DEF("update", 1, js_blake2b_write),
+    JS_CFUNC_DEF("updateFromSyscall", 5, js_blake2b_update_from_syscall),
     JS_CFUNC_DEF("finalize", 0, js_blake2b_finalize),
 };
 
@@ -344,19 +612,16 @@ fail:
     return JS_EXCEPTION;
 }
 
+static void ripemd160_update_func(void *state, const uint8_t *data, size_t len) { ripemd160_update(state, data, len); }
+
 // Method definitions for Ripemd160 prototype
 static JSValue js_ripemd160_write(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
-    size_t data_len;
-    uint8_t *data;
     ripemd160_state *hash;
 
     hash = JS_GetOpaque2(ctx, this_val, js_ripemd160_class_id);
     if (!hash) return JS_EXCEPTION;
 
-    data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
-    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
-
-    ripemd160_update(hash, data, data_len);
+    if (hash_update_values(ctx, hash, ripemd160_update_func, argc, argv)) return JS_EXCEPTION;
     return JS_UNDEFINED;
 }
 
@@ -375,11 +640,126 @@ static JSValue js_ripemd160_finalize(JSContext *ctx, JSValueConst this_val, int
     return JS_NewArrayBuffer(ctx, output, RIPEMD160_SIZE, free_hash_context, NULL, false);
 }
 
+static JSValue js_ripemd160_update_from_syscall(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    ripemd160_state *hash = JS_GetOpaque2(ctx, this_val, js_ripemd160_class_id);
+    if (!hash) return JS_EXCEPTION;
+    return hash_update_from_syscall(ctx, hash, ripemd160_update_func, argc, argv);
+}
+
 static const JSCFunctionListEntry js_ripemd160_proto_funcs[] = {
     JS_CFUNC_DEF("update", 1, js_ripemd160_write),
+    JS_CFUNC_DEF("updateFromSyscall", 5, js_ripemd160_update_from_syscall),
     JS_CFUNC_DEF("finalize", 0, js_ripemd160_finalize),
 };
 
+// Blake2b-256 with the ckb-default-hash personalization of the item loaded by
+// `kind`, streamed through hash_from_syscall
+static JSValue hash_ckb_from_syscall(JSContext *ctx, int kind, int argc, JSValueConst *argv) {
+    blake2b_state state;
+    size_t index, source, offset, length, hashed = 0;
+    uint8_t *output;
+
+    if (parse_syscall_args(ctx, argc, argv, 0, &index, &source, &offset, &length)) {
+        return JS_EXCEPTION;
+    }
+    if (js_blake2b_init(&state, BLAKE2B_HASH_SIZE, "ckb-default-hash") < 0) {
+        return JS_ThrowInternalError(ctx, "Failed to initialize Blake2b hash");
+    }
+    int err = hash_from_syscall(&state, blake2b_update_func, kind, index, source, offset, length, &hashed);
+    if (err != 0) {
+        return qjs_throw_error(ctx, err, "ckb syscall error");
+    }
+    output = js_malloc(ctx, BLAKE2B_HASH_SIZE);
+    if (!output) return JS_ThrowOutOfMemory(ctx);
+
+    blake2b_final(&state, output, BLAKE2B_HASH_SIZE);
+    return JS_NewArrayBuffer(ctx, output, BLAKE2B_HASH_SIZE, free_hash_context, NULL, false);
+}
+
+// One-shot hashes of a single ArrayBuffer. The hash state lives on the stack
+// and the digest is written straight into the returned buffer, skipping the
+// object, opaque state and finalizer of the hash classes.
+static JSValue js_sha256_digest(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    SHA256_CTX hash;
+    size_t data_len;
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
+    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
+    uint8_t *output = js_malloc(ctx, SHA256_BLOCK_SIZE);
+    if (!output) return JS_ThrowOutOfMemory(ctx);
+
+    sha256_init(&hash);
+    sha256_update(&hash, data, data_len);
+    sha256_final(&hash, output);
+    return JS_NewArrayBuffer(ctx, output, SHA256_BLOCK_SIZE, free_hash_context, NULL, false);
+}
+
+static JSValue js_keccak256_digest(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    SHA3_CTX hash;
+    const size_t KECCAK256_SIZE = 32;
+    size_t data_len;
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
+    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
+    uint8_t *output = js_malloc(ctx, KECCAK256_SIZE);
+    if (!output) return JS_ThrowOutOfMemory(ctx);
+
+    keccak_init(&hash);
+    keccak256_update_func(&hash, data, data_len);
+    keccak_final(&hash, output);
+    return JS_NewArrayBuffer(ctx, output, KECCAK256_SIZE, free_hash_context, NULL, false);
+}
+
+static JSValue js_ripemd160_digest(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    ripemd160_state hash;
+    const size_t RIPEMD160_SIZE = 20;
+    size_t data_len;
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
+    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
+    uint8_t *output = js_malloc(ctx, RIPEMD160_SIZE);
+    if (!output) return JS_ThrowOutOfMemory(ctx);
+
+    ripemd160_init(&hash);
+    ripemd160_update(&hash, data, data_len);
+    ripemd160_finalize(&hash, output);
+    return JS_NewArrayBuffer(ctx, output, RIPEMD160_SIZE, free_hash_context, NULL, false);
+}
+
+// blake2b256(data, [personal]), personal defaults to "ckb-default-hash"
+static JSValue js_blake2b256_digest(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    blake2b_state hash;
+    char personal[BLAKE2B_PERSONALBYTES] = "ckb-default-hash";
+    size_t data_len;
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
+    if (!data) return JS_ThrowTypeError(ctx, "invalid data");
+    if (!JS_IsUndefined(argv[1])) {
+        size_t personal_len;
+        const char *str = JS_ToCStringLen(ctx, &personal_len, argv[1]);
+        if (!str) return JS_EXCEPTION;
+        if (personal_len != BLAKE2B_PERSONALBYTES) {
+            JS_FreeCString(ctx, str);
+            return JS_ThrowTypeError(ctx, "personal must be %d bytes", BLAKE2B_PERSONALBYTES);
+        }
+        memcpy(personal, str, BLAKE2B_PERSONALBYTES);
+        JS_FreeCString(ctx, str);
+    }
+    if (js_blake2b_init(&hash, BLAKE2B_HASH_SIZE, personal) < 0) {
+        return JS_ThrowInternalError(ctx, "Failed to initialize Blake2b hash");
+    }
+    uint8_t *output = js_malloc(ctx, BLAKE2B_HASH_SIZE);
+    if (!output) return JS_ThrowOutOfMemory(ctx);
+
+    blake2b_update(&hash, data, data_len);
+    blake2b_final(&hash, output, BLAKE2B_HASH_SIZE);
+    return JS_NewArrayBuffer(ctx, output, BLAKE2B_HASH_SIZE, free_hash_context, NULL, false);
+}
+
+static JSValue js_hash_witness(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return hash_ckb_from_syscall(ctx, HASH_LOAD_WITNESS, argc, argv);
+}
+
+static JSValue js_hash_cell_data(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    return hash_ckb_from_syscall(ctx, HASH_LOAD_CELL_DATA, argc, argv);
+}
+
 int qjs_init_module_hash_lazy(JSContext *ctx, JSModuleDef *m) {
     JSValue proto, obj;
 
@@ -435,6 +815,16 @@ int qjs_init_module_hash_lazy(JSContext *ctx, JSModuleDef *m) {
     JS_SetClassProto(ctx, js_ripemd160_class_id, proto);
     JS_SetModuleExport(ctx, m, "Ripemd160", obj);
 
+    JS_SetModuleExport(ctx, m, "sha256", JS_NewCFunction(ctx, js_sha256_digest, "sha256", 1));
+    JS_SetModuleExport(ctx, m, "keccak256", JS_NewCFunction(ctx, js_keccak256_digest, "keccak256", 1));
+    JS_SetModuleExport(ctx, m, "ripemd160", JS_NewCFunction(ctx, js_ripemd160_digest, "ripemd160", 1));
+    JS_SetModuleExport(ctx, m, "blake2b256", JS_NewCFunction(ctx, js_blake2b256_digest, "blake2b256", 2));
+    JS_SetModuleExport(ctx, m, "hashWitness", JS_NewCFunction(ctx, js_hash_witness, "hashWitness", 4));
+    JS_SetModuleExport(ctx, m, "hashCellData", JS_NewCFunction(ctx, js_hash_cell_data, "hashCellData", 4));
+    for (size_t i = 0; i < countof(syscall_kinds); i++) {
+        JS_SetModuleExport(ctx, m, syscall_kinds[i].name, JS_NewInt32(ctx, syscall_kinds[i].kind));
+    }
+
     return 0;
 }
 
@@ -443,5 +833,14 @@ int qjs_init_module_hash(JSContext *ctx, JSModuleDef *m) {
     JS_AddModuleExport(ctx, m, "Keccak256");
     JS_AddModuleExport(ctx, m, "Blake2b");
     JS_AddModuleExport(ctx, m, "Ripemd160");
+    JS_AddModuleExport(ctx, m, "sha256");
+    JS_AddModuleExport(ctx, m, "keccak256");
+    JS_AddModuleExport(ctx, m, "ripemd160");
+    JS_AddModuleExport(ctx, m, "blake2b256");
+    JS_AddModuleExport(ctx, m, "hashWitness");
+    JS_AddModuleExport(ctx, m, "hashCellData");
+    for (size_t i = 0; i < countof(syscall_kinds); i++) {
+        JS_AddModuleExport(ctx, m, syscall_kinds[i].name);
+    }
     return 0;
 }
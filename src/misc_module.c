@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <malloc.h>
 #include "cutils.h"
 #include "quickjs.h"
 #include "misc_module.h"
@@ -53,8 +54,8 @@ static JSValue js_smt_insert(JSContext *ctx, JSValueConst this_val, int argc, JS
     if (!w) return JS_EXCEPTION;
 
     size_t key_len, value_len;
-    uint8_t *key = JS_GetArrayBuffer(ctx, &key_len, argv[0]);
-    uint8_t *value = JS_GetArrayBuffer(ctx, &value_len, argv[1]);
+    uint8_t *key = qjs_get_bytes(ctx, argv[0], &key_len);
+    uint8_t *value = qjs_get_bytes(ctx, argv[1], &value_len);
 
     if (!key || !value || key_len != SMT_KEY_BYTES || value_len != SMT_VALUE_BYTES)
         return JS_ThrowTypeError(ctx, "Invalid key or value format");
@@ -83,8 +84,8 @@ static JSValue js_smt_verify(JSContext *ctx, JSValueConst this_val, int argc, JS
     if (!w) return JS_EXCEPTION;
 
     size_t root_len, proof_len;
-    uint8_t *root = JS_GetArrayBuffer(ctx, &root_len, argv[0]);
-    uint8_t *proof = JS_GetArrayBuffer(ctx, &proof_len, argv[1]);
+    uint8_t *root = qjs_get_bytes(ctx, argv[0], &root_len);
+    uint8_t *proof = qjs_get_bytes(ctx, argv[1], &proof_len);
 
     if (!root || root_len != SMT_VALUE_BYTES || !proof) return JS_ThrowTypeError(ctx, "Invalid root or proof format");
 
@@ -123,7 +124,7 @@ static void js_smt_finalizer(JSRuntime *rt, JSValue val) {
 // Convert ArrayBuffer to hex string
 static JSValue js_encode_hex(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     size_t data_len;
-    uint8_t *data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
     if (!data) return JS_ThrowTypeError(ctx, "Expected ArrayBuffer");
 
     // Each byte becomes 2 hex characters
@@ -191,7 +192,7 @@ static JSValue js_decode_hex(JSContext *ctx, JSValueConst this_val, int argc, JS
 // Convert ArrayBuffer to base64 string
 static JSValue js_encode_base64(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     size_t data_len;
-    uint8_t *data = JS_GetArrayBuffer(ctx, &data_len, argv[0]);
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
     if (!data) return JS_ThrowTypeError(ctx, "Expected ArrayBuffer");
 
     char *base64 = NULL;
@@ -201,7 +202,8 @@ static JSValue js_encode_base64(JSContext *ctx, JSValueConst this_val, int argc,
         return JS_ThrowTypeError(ctx, "base64 encode error");
     }
     JSValue result = JS_NewString(ctx, base64);
-    js_free(ctx, base64);
+    // allocated by qjs_base64_encode with malloc
+    free(base64);
     return result;
 }
 
@@ -446,26 +448,41 @@ static JSValue js_std_printf(JSContext *ctx, JSValueConst this_val, int argc, JS
     return js_printf_internal(ctx, argc, argv, true);
 }
 
+static JSValue js_memory_stats(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    struct malloc_stats stats;
+    malloc_get_stats(&stats);
+    JSValue obj = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "brkUsed", JS_NewInt64(ctx, (int64_t)malloc_usage()));
+    JS_SetPropertyStr(ctx, obj, "reservedBytes", JS_NewInt64(ctx, (int64_t)stats.reserved_bytes));
+    JS_SetPropertyStr(ctx, obj, "liveBytes", JS_NewInt64(ctx, (int64_t)stats.live_bytes));
+    JS_SetPropertyStr(ctx, obj, "peakLiveBytes", JS_NewInt64(ctx, (int64_t)stats.peak_live_bytes));
+    JS_SetPropertyStr(ctx, obj, "peakLiveCycles", JS_NewInt64(ctx, (int64_t)stats.peak_live_cycles));
+    JS_SetPropertyStr(ctx, obj, "frees", JS_NewInt64(ctx, (int64_t)stats.free_count));
+    JS_SetPropertyStr(ctx, obj, "reallocs", JS_NewInt64(ctx, (int64_t)stats.realloc_count));
+    JS_SetPropertyStr(ctx, obj, "reallocsInPlace", JS_NewInt64(ctx, (int64_t)stats.realloc_in_place_count));
+    JSValue allocs = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < MALLOC_STATS_CLASS_COUNT; i++) {
+        JS_SetPropertyUint32(ctx, allocs, i, JS_NewInt64(ctx, (int64_t)stats.alloc_count[i]));
+    }
+    JS_SetPropertyStr(ctx, obj, "allocsBySize", allocs);
+    return obj;
+}
+
 static const JSCFunctionListEntry js_misc_funcs[] = {
     JS_CFUNC_DEF("throw_exception", 1, js_throw_exception),
     JS_CFUNC_DEF("sprintf", 1, js_std_sprintf),
     JS_CFUNC_DEF("printf", 1, js_std_printf),
+    JS_CFUNC_DEF("memoryStats", 0, js_memory_stats),
 };
 
 // TextDecoder decode method
 static JSValue js_text_decoder_decode(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     size_t data_len = 0;
-    uint8_t *data = NULL;
-    size_t per_element = 0;
-    JSValue value = JS_GetTypedArrayBuffer(ctx, argv[0], NULL, NULL, &per_element);
-
-    if (JS_IsException(value) || per_element != 1) {
+    uint8_t *data = qjs_get_bytes(ctx, argv[0], &data_len);
+    if (!data) {
         return JS_ThrowTypeError(ctx, "Invalid argument type");
     }
-    data = JS_GetArrayBuffer(ctx, &data_len, value);
-    JSValue result = JS_NewStringLen(ctx, (char *)data, data_len);
-    JS_FreeValue(ctx, value);
-    return result;
+    return JS_NewStringLen(ctx, (char *)data, data_len);
 }
 
 // TextEncoder encode method
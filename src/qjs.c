@@ -32,16 +32,68 @@
 #include "cutils.h"
 #include "std_module.h"
 #include "ckb_module.h"
+#ifndef NO_SECP256K1
 #include "secp256k1_module.h"
+#endif
 #include "hash_module.h"
 #include "misc_module.h"
+#include "slab_malloc.h"
 #include "ckb_exec.h"
 #include "qjs.h"
 
 #define INIT_FILE_NAME "init.js"
-#define INIT_FILE_NAME_BC "init.bc"
 #define ENTRY_FILE_NAME "index.js"
-#define ENTRY_FILE_NAME_BC "index.bc"
+
+#ifdef BOOT_PROFILE
+#include "ckb_syscall_apis.h"
+
+#define BOOT_PROFILE_MAX_PHASES 16
+
+// Cycles spent in each boot phase, reported as one `[boot-profile]` line per
+// phase so that tools (e.g. ckb-testtool's Verifier) can parse them.
+static struct {
+    const char *name;
+    uint64_t cycles;
+} g_boot_phases[BOOT_PROFILE_MAX_PHASES];
+static size_t g_boot_phase_count = 0;
+static uint64_t g_boot_last_cycles = 0;
+
+static void boot_profile_start(void) { g_boot_last_cycles = ckb_current_cycles(); }
+
+// Record the cycles consumed since the previous mark as the phase `name`.
+static void boot_profile_mark(const char *name) {
+    uint64_t now = ckb_current_cycles();
+    if (g_boot_phase_count < BOOT_PROFILE_MAX_PHASES) {
+        g_boot_phases[g_boot_phase_count].name = name;
+        g_boot_phases[g_boot_phase_count].cycles = now - g_boot_last_cycles;
+        g_boot_phase_count++;
+    }
+    g_boot_last_cycles = ckb_current_cycles();
+}
+
+// A failed boot reports the phases it completed, then the cycles spent in the
+// phase that failed as `phase=failed`.
+static void boot_profile_report(int err) {
+    if (err != 0) {
+        boot_profile_mark("failed");
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < g_boot_phase_count; i++) {
+        printf("[boot-profile] phase=%s cycles=%llu", g_boot_phases[i].name,
+               (unsigned long long)g_boot_phases[i].cycles);
+        total += g_boot_phases[i].cycles;
+    }
+    printf("[boot-profile] total cycles=%llu", (unsigned long long)total);
+}
+
+#define BOOT_PROFILE_START() boot_profile_start()
+#define BOOT_PROFILE_MARK(name) boot_profile_mark(name)
+#define BOOT_PROFILE_REPORT(err) boot_profile_report(err)
+#else
+#define BOOT_PROFILE_START()
+#define BOOT_PROFILE_MARK(name)
+#define BOOT_PROFILE_REPORT(err)
+#endif
 
 static void js_dump_obj(JSContext *ctx, JSValueConst val) {
     const char *str;
@@ -124,7 +176,7 @@ int ckb_debugger_fwrite(const void *ptr, size_t size, size_t nitems, long stream
     return syscall(9012, (long)ptr, (long)size, (long)nitems, (long)stream, 0, 0);
 }
 
-int compile_from_file(JSContext *ctx, const char *bytecode_filename) {
+int compile_from_file(JSContext *ctx, const char *bytecode_filename, bool snapshot) {
     enable_local_access(1);
     char buf[1024 * 512];
     int buf_len = qjs_read_local_file(buf, sizeof(buf));
@@ -149,6 +201,21 @@ int compile_from_file(JSContext *ctx, const char *bytecode_filename) {
     out_buf = JS_WriteObject(ctx, &out_buf_len, val, JS_WRITE_OBJ_BYTECODE);
     if (!out_buf) return QJS_ERROR_MEMORY_ALLOCATION;
     long handle = ckb_debugger_fopen(bytecode_filename, "wb");
+    if (snapshot) {
+        QJSSnapshotHeader header = {
+            .magic = QJS_SNAPSHOT_MAGIC,
+            .version = QJS_SNAPSHOT_VERSION,
+            .bc_version = BC_VERSION,
+            .bytecode_offset = sizeof(QJSSnapshotHeader),
+            .bytecode_length = out_buf_len,
+        };
+        int written = ckb_debugger_fwrite(&header, 1, sizeof(header), handle);
+        if (written != sizeof(header)) {
+            ckb_debugger_fclose(handle);
+            printf("Error while writing to file %s", bytecode_filename);
+            return QJS_ERROR_GENERIC;
+        }
+    }
     int written = ckb_debugger_fwrite(out_buf, 1, out_buf_len, handle);
     if (written != out_buf_len) {
         ckb_debugger_fclose(handle);
@@ -169,8 +236,13 @@ static int eval_buf(JSContext *ctx, const void *buf, int buf_len, const char *fi
      * - Provides better scoping isolation
      */
     int eval_flags = JS_EVAL_TYPE_MODULE;
-    if (((const char *)buf)[0] == (char)BC_VERSION) {
-        val = JS_ReadObject(ctx, buf, buf_len, JS_READ_OBJ_BYTECODE);
+    bool is_snapshot = js_is_snapshot(buf, buf_len);
+    if (is_snapshot || ((const char *)buf)[0] == (char)BC_VERSION) {
+        if (is_snapshot) {
+            val = js_read_snapshot(ctx, (uint8_t *)buf, buf_len);
+        } else {
+            val = JS_ReadObject(ctx, buf, buf_len, JS_READ_OBJ_BYTECODE);
+        }
         if (JS_IsException(val)) {
             js_std_dump_error(ctx);
             return QJS_ERROR_GENERIC;
@@ -220,27 +292,31 @@ static int eval_buf(JSContext *ctx, const void *buf, int buf_len, const char *fi
 int run_from_file_system_buf(JSContext *ctx, char *buf, size_t buf_size) {
     int err = ckb_load_fs("/", buf, buf_size);
     CHECK(err);
+    BOOT_PROFILE_MARK("mount");
 
+    // init.bc and index.bc are the fallbacks of init.js and index.js
     FSFile *init_file = NULL;
-    err = ckb_get_file(INIT_FILE_NAME, &init_file);
-    if (err != 0) {
-        ckb_get_file(INIT_FILE_NAME_BC, &init_file);
-        // skip error checking
-    }
+    ckb_get_module_file(INIT_FILE_NAME, &init_file);
+    // skip error checking
     if (init_file) {
         err = eval_buf(ctx, init_file->content, init_file->size, INIT_FILE_NAME, false);
+        ckb_release_file(init_file);
         CHECK(err);
+        BOOT_PROFILE_MARK("init");
     }
 
     FSFile *entry_file = NULL;
-    err = ckb_get_file(ENTRY_FILE_NAME, &entry_file);
-    if (err != 0) {
-        err = ckb_get_file(ENTRY_FILE_NAME_BC, &entry_file);
-    }
+    err = ckb_get_module_file(ENTRY_FILE_NAME, &entry_file);
     CHECK(err);
-    CHECK2(entry_file->size > 0, QJS_ERROR_EMPTY_FILE);
+    if (entry_file->size == 0) {
+        ckb_release_file(entry_file);
+        err = QJS_ERROR_EMPTY_FILE;
+        goto exit;
+    }
     err = eval_buf(ctx, entry_file->content, entry_file->size, ENTRY_FILE_NAME, true);
+    ckb_release_file(entry_file);
     CHECK(err);
+    BOOT_PROFILE_MARK("entry");
 
 exit:
     return err;
@@ -249,22 +325,19 @@ exit:
 static int run_from_local_file(JSContext *ctx, bool enable_fs) {
     printf("Run from file, local access enabled. For Testing only.\n");
     enable_local_access(1);
-    char buf[1024 * 512];
-    int count = qjs_read_local_file(buf, sizeof(buf));
-    if (count < 0 || count == sizeof(buf)) {
-        if (count == sizeof(buf)) {
-            printf("Error while reading from file: file too large\n");
-            return QJS_ERROR_FILE_TOO_LARGE;
-        } else {
-            printf("Error while reading from file: %d\n", count);
-            return QJS_ERROR_FILE_READ;
-        }
+    uint8_t *buf = NULL;
+    size_t count = 0;
+    int err = qjs_load_local_code(&buf, &count);
+    if (err) {
+        return err;
     }
+    BOOT_PROFILE_MARK("load_code");
     if (enable_fs) {
-        return run_from_file_system_buf(ctx, buf, (size_t)count);
+        return run_from_file_system_buf(ctx, (char *)buf, count);
     } else {
-        buf[count] = 0;
-        return eval_buf(ctx, buf, count, "<run_from_file>", true);
+        err = eval_buf(ctx, buf, count, "<run_from_file>", true);
+        BOOT_PROFILE_MARK("entry");
+        return err;
     }
 }
 
@@ -272,25 +345,31 @@ static int run_from_cell_data(JSContext *ctx, bool enable_fs) {
     int err = 0;
     size_t buf_size = 0;
     size_t index = 0;
-    bool use_filesystem = false;
-    err = qjs_load_cell_code_info(&buf_size, &index, &use_filesystem);
+    uint16_t flags = 0;
+    err = qjs_load_cell_code_info(&index, &flags);
     if (err) {
         return err;
     }
+    if (flags & QJS_FLAG_LAZY_MODULES) {
+        js_std_set_lazy_modules(true);
+    }
+    if (flags & QJS_FLAG_ARENA) {
+        qjs_set_arena_malloc(true);
+    }
 
-    char *buf = malloc(buf_size + 1);
-    err = qjs_load_cell_code(buf_size, index, (uint8_t *)buf);
+    // The code region is owned by ckb_module.c and lives until exit: the file
+    // system entries and the bytecode are consumed in place, never copied.
+    uint8_t *buf = NULL;
+    err = qjs_load_cell_code(index, &buf, &buf_size);
     if (err) {
         return err;
     }
-    if (enable_fs || use_filesystem) {
-        err = run_from_file_system_buf(ctx, buf, buf_size);
-        free(buf);
-        return err;
+    BOOT_PROFILE_MARK("load_code");
+    if (enable_fs || (flags & QJS_FLAG_FILESYSTEM)) {
+        return run_from_file_system_buf(ctx, (char *)buf, buf_size);
     } else {
-        buf[buf_size] = 0;
         err = eval_buf(ctx, buf, buf_size, "<run_from_file>", true);
-        free(buf);
+        BOOT_PROFILE_MARK("entry");
         return err;
     }
 }
@@ -313,25 +392,23 @@ static int run_from_target(JSContext *ctx, const char *target, bool enable_fs) {
     size_t buf_size = 0;
     size_t index = 0;
 
-    err = qjs_load_cell_code_info_explicit(&buf_size, &index, code_hash, hash_type);
+    err = qjs_load_cell_code_info_explicit(&index, code_hash, hash_type);
     if (err) {
         return err;
     }
 
-    char *buf = malloc(buf_size + 1);
-    err = qjs_load_cell_code(buf_size, index, (uint8_t *)buf);
+    uint8_t *buf = NULL;
+    err = qjs_load_cell_code(index, &buf, &buf_size);
     if (err) {
         return err;
     }
+    BOOT_PROFILE_MARK("load_code");
 
     if (enable_fs) {
-        err = run_from_file_system_buf(ctx, buf, buf_size);
-        free(buf);
-        return err;
+        return run_from_file_system_buf(ctx, (char *)buf, buf_size);
     } else {
-        buf[buf_size] = 0;
         err = eval_buf(ctx, buf, buf_size, "<run_from_file>", true);
-        free(buf);
+        BOOT_PROFILE_MARK("entry");
         return err;
     }
 }
@@ -348,7 +425,9 @@ static int init_func(JSContext *ctx, JSModuleDef *m) {
     qjs_init_module_ckb_lazy(ctx, m);
     qjs_init_module_hash_lazy(ctx, m);
     qjs_init_module_misc_lazy(ctx, m);
+#ifndef NO_SECP256K1
     qjs_init_module_secp256k1_lazy(ctx, m);
+#endif
     return 0;
 }
 
@@ -359,10 +438,13 @@ static void print_help_message(void) {
     printf("Options:\n");
     printf("  -h, --help        show this help message\n");
     printf("  -c                compile javascript to bytecode\n");
+    printf("  -s                compile javascript to snapshot\n");
     printf("  -e <code>         run javascript from argument value\n");
     printf("  -r                read from file\n");
     printf("  -t <target>       specify target code_hash and hash_type in hex\n");
     printf("  -f                use file system\n");
+    printf("  -l                load modules required from the file system lazily\n");
+    printf("  -a                allocate from an arena that is never freed\n");
 }
 
 int main(int argc, const char **argv) {
@@ -373,6 +455,7 @@ int main(int argc, const char **argv) {
     // command line parsing
     size_t optind = 0;
     bool c_flag = false;         // compile flag
+    bool s_flag = false;         // compile to snapshot flag
     bool r_flag = false;         // read from file flag
     bool f_flag = false;         // use filesystem flag
     const char *e_value = NULL;  // eval argument
@@ -389,6 +472,11 @@ int main(int argc, const char **argv) {
             c_flag = true;
             bytecode_filename = argv[i + 1];
             optind = i + 2;
+        } else if (strcmp(arg, "-s") == 0) {
+            c_flag = true;
+            s_flag = true;
+            bytecode_filename = argv[i + 1];
+            optind = i + 2;
         } else if (strcmp(arg, "-e") == 0) {
             if (i + 1 < argc) {
                 e_value = argv[++i];
@@ -403,6 +491,12 @@ int main(int argc, const char **argv) {
         } else if (strcmp(arg, "-f") == 0) {
             f_flag = true;
             optind = i + 1;
+        } else if (strcmp(arg, "-l") == 0) {
+            js_std_set_lazy_modules(true);
+            optind = i + 1;
+        } else if (strcmp(arg, "-a") == 0) {
+            qjs_set_arena_malloc(true);
+            optind = i + 1;
         } else if (strcmp(arg, "-t") == 0) {
             if (i + 1 < argc) {
                 t_value = argv[++i];
@@ -414,12 +508,18 @@ int main(int argc, const char **argv) {
         }
     }
 
+    BOOT_PROFILE_START();
     size_t memory_limit = 0;
+#ifdef NO_SLAB_MALLOC
     rt = JS_NewRuntime();
+#else
+    rt = JS_NewRuntime2(&qjs_slab_malloc_funcs, NULL);
+#endif
     if (!rt) {
         printf("qjs: cannot allocate JS runtime\n");
         return QJS_ERROR_GENERIC;
     }
+    BOOT_PROFILE_MARK("new_runtime");
     if (memory_limit != 0) JS_SetMemoryLimit(rt, memory_limit);
     // see docs/src/security.md for more information.
     size_t stack_size = CKB_MEMORY_LIMIT - CKB_BRK_MAX - 4096;
@@ -437,6 +537,7 @@ int main(int argc, const char **argv) {
     // js_std_init_handlers(rt);
     ctx = JS_NewCustomContext(rt);
     CHECK2(ctx != NULL, QJS_ERROR_GENERIC);
+    BOOT_PROFILE_MARK("new_context");
     /* loader for ES6 modules */
     JS_SetModuleLoaderFunc(rt, NULL, js_module_loader, NULL);
     // Now passing remaining arguments after the flags
@@ -446,20 +547,19 @@ int main(int argc, const char **argv) {
     qjs_init_module_ckb(ctx, m);
     qjs_init_module_hash(ctx, m);
     qjs_init_module_misc(ctx, m);
+#ifndef NO_SECP256K1
     qjs_init_module_secp256k1(ctx, m);
-    const char *require_script =
-        "import * as ckb from '@ckb-js-std/bindings';\n"
-        "globalThis.__ckb_module = ckb;  \n"
-        "globalThis.require = function (name) { \n"
-        " if (name === '@ckb-js-std/bindings') { \n"
-        " return globalThis.__ckb_module; }\n"
-        " throw new Error('cannot find the module: ' + name); } \0";
-    err = eval_buf(ctx, require_script, strlen(require_script), "<require script>", false);
+#endif
+    BOOT_PROFILE_MARK("init_modules");
+    err = js_std_register_module("@ckb-js-std/bindings", m);
+    CHECK(err);
+    err = js_std_add_require(ctx);
     CHECK(err);
+    BOOT_PROFILE_MARK("require");
     // Replace the command-line handling logic
     if (c_flag) {
         JS_SetModuleLoaderFunc(rt, NULL, js_module_dummy_loader, NULL);
-        err = compile_from_file(ctx, bytecode_filename);
+        err = compile_from_file(ctx, bytecode_filename, s_flag);
     } else if (e_value) {
         err = eval_buf(ctx, e_value, strlen(e_value), "<cmdline>", true);
     } else if (r_flag && f_flag) {
@@ -478,15 +578,18 @@ int main(int argc, const char **argv) {
     CHECK(err);
     err = js_std_loop(ctx);
     CHECK(err);
+    BOOT_PROFILE_MARK("pending_jobs");
 
 #ifdef MEMORY_USAGE
     size_t heap_usage = malloc_usage();
     printf("Total bytes used by allocator(malloc/realloc) is %d K\n", heap_usage / 1024);
     size_t stack_usage = JS_GetStackPeak();
     printf("Total bytes used by stack(peak value) is %d K\n", (4 * 1024 * 1024 - stack_usage) / 1024);
+    malloc_print_stats("memory");
 #endif
 
 exit:
+    BOOT_PROFILE_REPORT(err);
     // No cleanup is needed.
     // js_std_free_handlers(rt);
     // JS_FreeContext(ctx);
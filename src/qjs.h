@@ -1,6 +1,8 @@
 #ifndef __QJS_H__
 #define __QJS_H__
 
+#include <stdint.h>
+
 // Define meaningful enum names for exit codes
 typedef enum {
     QJS_SUCCESS = 0,
@@ -19,6 +21,7 @@ typedef enum {
     QJS_ERROR_EVAL = -13,
     QJS_ERROR_FS = -14,
     QJS_ERROR_LOAD_CODE = -15,
+    QJS_ERROR_OVERFLOW = -16,
 } QJSErrorCode;
 
 #define CHECK2(cond, code)                                                                                     \
@@ -52,4 +55,23 @@ typedef enum {
 #define BC_VERSION BC_BASE_VERSION
 #endif
 
+// A snapshot is a bytecode image prefixed with this header. Instead of being
+// deserialized, it is mapped in place: function bytecode is used directly from
+// the image and only atom operands are patched. The first byte is a UTF-8
+// continuation byte, so it never collides with JavaScript source or plain
+// bytecode.
+#define QJS_SNAPSHOT_MAGIC 0x53534a81  // "\x81JSS"
+#define QJS_SNAPSHOT_VERSION 1
+
+typedef struct QJSSnapshotHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t bc_version;
+    // set once the image has been patched, it can't be mapped twice.
+    uint8_t mapped;
+    uint8_t reserved;
+    uint32_t bytecode_offset;
+    uint32_t bytecode_length;
+} QJSSnapshotHeader;
+
 #endif  //__QJS_H__
\ No newline at end of file
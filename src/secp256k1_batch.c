@@ -0,0 +1,135 @@
+// Schnorr batch verification. The upstream library has no batch API, and the
+// multi-scalar multiplication it needs is internal to secp256k1.c, so this file
+// includes secp256k1.c and is built in its place (see the Makefile).
+#include "secp256k1.c"
+#include "secp256k1_batch.h"
+
+typedef struct {
+    const secp256k1_scalar* scalars;
+    const secp256k1_ge* points;
+} secp256k1_schnorrsig_batch_data;
+
+static int secp256k1_schnorrsig_batch_callback(secp256k1_scalar* sc, secp256k1_ge* pt, size_t idx, void* data) {
+    const secp256k1_schnorrsig_batch_data* batch = (const secp256k1_schnorrsig_batch_data*)data;
+    *sc = batch->scalars[idx];
+    *pt = batch->points[idx];
+    return 1;
+}
+
+// Enough scratch space for secp256k1_ecmult_multi_var to take all points in a
+// single batch, with whichever algorithm it picks for that many points.
+static size_t secp256k1_schnorrsig_batch_scratch_size(size_t n_points) {
+    if (n_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
+        return secp256k1_pippenger_scratch_size(n_points, bucket_window) + PIPPENGER_SCRATCH_OBJECTS * ALIGNMENT;
+    }
+    return secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS * ALIGNMENT;
+}
+
+int secp256k1_schnorrsig_verify_batch(const secp256k1_context* ctx, const unsigned char* sig64s,
+                                      const unsigned char* msg32s, size_t msg_step,
+                                      const secp256k1_xonly_pubkey* pubkeys, size_t n_sigs) {
+    secp256k1_sha256 sha;
+    unsigned char seed[32];
+    unsigned char buf[32];
+    secp256k1_scalar g_scalar, a, ae;
+    secp256k1_fe rx;
+    secp256k1_gej rj;
+    secp256k1_schnorrsig_batch_data data;
+    secp256k1_scalar* scalars = NULL;
+    secp256k1_ge* points = NULL;
+    secp256k1_scratch* scratch = NULL;
+    size_t i;
+    int overflow;
+    int ret = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig64s != NULL);
+    ARG_CHECK(msg32s != NULL);
+    ARG_CHECK(pubkeys != NULL);
+    if (n_sigs == 0) {
+        return 1;
+    }
+
+    // Entry 2i is R_i, entry 2i + 1 is P_i. Until the randomizers are known,
+    // the scalars hold s_i and e_i.
+    scalars = (secp256k1_scalar*)malloc(2 * n_sigs * sizeof(secp256k1_scalar));
+    points = (secp256k1_ge*)malloc(2 * n_sigs * sizeof(secp256k1_ge));
+    if (scalars == NULL || points == NULL) {
+        goto exit;
+    }
+
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n_sigs; i++) {
+        const unsigned char* sig64 = sig64s + i * 64;
+        const unsigned char* msg32 = msg32s + i * msg_step;
+
+        if (!secp256k1_fe_set_b32_limit(&rx, &sig64[0])) {
+            goto exit;
+        }
+        // R_i is the point with x = r and an even y
+        if (!secp256k1_ge_set_xo_var(&points[2 * i], &rx, 0)) {
+            goto exit;
+        }
+        secp256k1_scalar_set_b32(&scalars[2 * i], &sig64[32], &overflow);
+        if (overflow) {
+            goto exit;
+        }
+        if (!secp256k1_xonly_pubkey_load(ctx, &points[2 * i + 1], &pubkeys[i])) {
+            goto exit;
+        }
+        secp256k1_fe_get_b32(buf, &points[2 * i + 1].x);
+        secp256k1_schnorrsig_challenge(&scalars[2 * i + 1], &sig64[0], msg32, 32, buf);
+
+        secp256k1_sha256_write(&sha, sig64, 64);
+        secp256k1_sha256_write(&sha, msg32, 32);
+        secp256k1_sha256_write(&sha, buf, 32);
+    }
+    secp256k1_sha256_finalize(&sha, seed);
+
+    // a_0 = 1 and a_i = sha256(seed || i). The randomizers depend on every
+    // input, so errors in several invalid signatures can't be chosen to cancel
+    // out in the sum.
+    secp256k1_scalar_set_int(&g_scalar, 0);
+    secp256k1_scalar_set_int(&a, 1);
+    for (i = 0; i < n_sigs; i++) {
+        if (i > 0) {
+            unsigned char index[8];
+            int j;
+            for (j = 0; j < 8; j++) {
+                index[j] = (unsigned char)((uint64_t)i >> (8 * (7 - j)));
+            }
+            secp256k1_sha256_initialize(&sha);
+            secp256k1_sha256_write(&sha, seed, 32);
+            secp256k1_sha256_write(&sha, index, 8);
+            secp256k1_sha256_finalize(&sha, buf);
+            secp256k1_scalar_set_b32(&a, buf, NULL);
+        }
+        secp256k1_scalar_mul(&scalars[2 * i], &scalars[2 * i], &a);
+        secp256k1_scalar_add(&g_scalar, &g_scalar, &scalars[2 * i]);
+        secp256k1_scalar_negate(&scalars[2 * i], &a);
+        secp256k1_scalar_mul(&ae, &scalars[2 * i + 1], &a);
+        secp256k1_scalar_negate(&scalars[2 * i + 1], &ae);
+    }
+
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_schnorrsig_batch_scratch_size(2 * n_sigs));
+    if (scratch == NULL) {
+        goto exit;
+    }
+    data.scalars = scalars;
+    data.points = points;
+    // sum(a_i * s_i) * G - sum(a_i * R_i) - sum(a_i * e_i * P_i) must be infinity
+    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, scratch, &rj, &g_scalar,
+                                    secp256k1_schnorrsig_batch_callback, &data, 2 * n_sigs)) {
+        goto exit;
+    }
+    ret = secp256k1_gej_is_infinity(&rj);
+
+exit:
+    if (scratch != NULL) {
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    }
+    free(points);
+    free(scalars);
+    return ret;
+}
@@ -0,0 +1,22 @@
+#ifndef _SECP256K1_BATCH_H_
+#define _SECP256K1_BATCH_H_
+
+#include <stddef.h>
+
+#include "secp256k1.h"
+#include "secp256k1_extrakeys.h"
+
+// Verify n_sigs BIP-340 signatures of 32-byte messages with a single combined
+// check: sum(a_i * s_i) * G == sum(a_i * R_i) + sum(a_i * e_i * P_i), where the
+// randomizers a_i are derived from everything being verified.
+//
+// sig64s holds the signatures back to back, msg32s the messages msg_step bytes
+// apart (0 when all signatures share one message). Returns 1 when all
+// signatures are valid. Returns 0 when at least one is invalid or the batch
+// could not be run, in which case the caller should verify them one by one with
+// secp256k1_schnorrsig_verify to tell which.
+int secp256k1_schnorrsig_verify_batch(const secp256k1_context* ctx, const unsigned char* sig64s,
+                                      const unsigned char* msg32s, size_t msg_step,
+                                      const secp256k1_xonly_pubkey* pubkeys, size_t n_sigs);
+
+#endif  // _SECP256K1_BATCH_H_
@@ -5,6 +5,7 @@
 #include "secp256k1_recovery.h"
 #include "secp256k1_schnorrsig.h"
 #include "secp256k1_extrakeys.h"
+#include "secp256k1_batch.h"
 #include "group.h"
 #undef CHECK
 #undef CHECK2
@@ -20,7 +21,16 @@
 // (not signing or key generation), we can safely use this minimal
 // placeholder to reduce memory usage.
 const secp256k1_ge_storage secp256k1_ecmult_gen_prec_table[0][0];
-const secp256k1_context *g_secp256k1_context = NULL;
+static secp256k1_context *g_secp256k1_context = NULL;
+
+// The verification context is created on the first secp256k1 or schnorr call,
+// so scripts that never check a signature don't pay for it at boot.
+static const secp256k1_context *get_context(void) {
+    if (g_secp256k1_context == NULL) {
+        g_secp256k1_context = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    }
+    return g_secp256k1_context;
+}
 
 static void free_array_buffer(JSRuntime *rt, void *_opaque, void *ptr) { js_free_rt(rt, ptr); }
 
@@ -34,7 +44,7 @@ static JSValue recover(JSContext *ctx, JSValueConst this_val, int argc, JSValueC
     if (argc != 3) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get signature from first argument
-    sig = JS_GetArrayBuffer(ctx, &sig_len, argv[0]);
+    sig = qjs_get_bytes(ctx, argv[0], &sig_len);
     if (!sig || sig_len != 64) return JS_ThrowTypeError(ctx, "invalid signature format");
 
     // Get recovery id from second argument
@@ -50,16 +60,16 @@ static JSValue recover(JSContext *ctx, JSValueConst this_val, int argc, JSValueC
     }
 
     // Parse the recoverable signature
-    if (!secp256k1_ecdsa_recoverable_signature_parse_compact(g_secp256k1_context, &signature, sig, recid)) {
+    if (!secp256k1_ecdsa_recoverable_signature_parse_compact(get_context(), &signature, sig, recid)) {
         return JS_ThrowTypeError(ctx, "invalid signature");
     }
 
     // Get message hash from third argument
-    msg = JS_GetArrayBuffer(ctx, &msg_len, argv[2]);
+    msg = qjs_get_bytes(ctx, argv[2], &msg_len);
     if (!msg || msg_len != 32) return JS_ThrowTypeError(ctx, "message must be 32 bytes");
 
     // Perform the recovery
-    int success = secp256k1_ecdsa_recover(g_secp256k1_context, &pubkey, &signature, msg);
+    int success = secp256k1_ecdsa_recover(get_context(), &pubkey, &signature, msg);
     if (!success) {
         return JS_ThrowInternalError(ctx, "invalid signature");
     }
@@ -77,7 +87,7 @@ static JSValue serialize_pubkey(JSContext *ctx, JSValueConst this_val, int argc,
     if (argc != 2) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get public key from first argument
-    pubkey_data = JS_GetArrayBuffer(ctx, &pubkey_len, argv[0]);
+    pubkey_data = qjs_get_bytes(ctx, argv[0], &pubkey_len);
     if (!pubkey_data || pubkey_len != sizeof(secp256k1_pubkey)) {
         return JS_ThrowTypeError(ctx, "invalid public key format");
     }
@@ -97,7 +107,7 @@ static JSValue serialize_pubkey(JSContext *ctx, JSValueConst this_val, int argc,
 
     // Serialize the public key
     size_t serialized_len = output_len;
-    if (!secp256k1_ec_pubkey_serialize(g_secp256k1_context, output, &serialized_len, &pubkey, flags)) {
+    if (!secp256k1_ec_pubkey_serialize(get_context(), output, &serialized_len, &pubkey, flags)) {
         js_free(ctx, output);
         return JS_ThrowInternalError(ctx, "serialization failed");
     }
@@ -114,13 +124,13 @@ static JSValue parse_pubkey(JSContext *ctx, JSValueConst this_val, int argc, JSV
     if (argc != 1) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get serialized public key from argument
-    input = JS_GetArrayBuffer(ctx, &input_len, argv[0]);
+    input = qjs_get_bytes(ctx, argv[0], &input_len);
     if (!input || (input_len != COMPRESSED_PUBKEY_LENGTH && input_len != UNCOMPRESSED_PUBKEY_LENGTH)) {
         return JS_ThrowTypeError(ctx, "invalid public key format");
     }
 
     // Parse the public key
-    if (!secp256k1_ec_pubkey_parse(g_secp256k1_context, &pubkey, input, input_len)) {
+    if (!secp256k1_ec_pubkey_parse(get_context(), &pubkey, input, input_len)) {
         return JS_ThrowTypeError(ctx, "invalid public key");
     }
 
@@ -138,20 +148,20 @@ static JSValue verify(JSContext *ctx, JSValueConst this_val, int argc, JSValueCo
     if (argc != 3) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get signature from first argument
-    sig = JS_GetArrayBuffer(ctx, &sig_len, argv[0]);
+    sig = qjs_get_bytes(ctx, argv[0], &sig_len);
     if (!sig || sig_len != 64) return JS_ThrowTypeError(ctx, "invalid signature format");
 
     // Parse the signature
-    if (!secp256k1_ecdsa_signature_parse_compact(g_secp256k1_context, &signature, sig)) {
+    if (!secp256k1_ecdsa_signature_parse_compact(get_context(), &signature, sig)) {
         return JS_ThrowTypeError(ctx, "invalid signature");
     }
 
     // Get message hash from second argument
-    msg = JS_GetArrayBuffer(ctx, &msg_len, argv[1]);
+    msg = qjs_get_bytes(ctx, argv[1], &msg_len);
     if (!msg || msg_len != 32) return JS_ThrowTypeError(ctx, "message must be 32 bytes");
 
     // Get public key from third argument
-    pubkey_data = JS_GetArrayBuffer(ctx, &pubkey_len, argv[2]);
+    pubkey_data = qjs_get_bytes(ctx, argv[2], &pubkey_len);
     if (!pubkey_data || pubkey_len != sizeof(secp256k1_pubkey)) {
         return JS_ThrowTypeError(ctx, "invalid public key format");
     }
@@ -159,16 +169,112 @@ static JSValue verify(JSContext *ctx, JSValueConst this_val, int argc, JSValueCo
     memcpy(&pubkey, pubkey_data, sizeof(secp256k1_pubkey));
 
     // Perform the verification
-    int result = secp256k1_ecdsa_verify(g_secp256k1_context, &signature, msg, &pubkey);
+    int result = secp256k1_ecdsa_verify(get_context(), &signature, msg, &pubkey);
 
     return JS_NewBool(ctx, result == 1);
 }
 
+// Message hashes of a batch: either one 32-byte hash shared by every
+// signature, or one per signature packed back to back. Returns the distance
+// between consecutive hashes (0 when shared), or -1 on a bad length.
+static int batch_msg_step(size_t msg_len, size_t count) {
+    if (msg_len == 32) return 0;
+    if (msg_len == count * 32) return 32;
+    return -1;
+}
+
+// verifyBatch(signatures, messageHashes, pubkeys) runs the whole loop of a
+// multisig check natively. Returns a bitmap ArrayBuffer of ceil(n / 8) bytes:
+// bit (i % 8) of byte (i / 8) is set when signature i is valid. A malformed
+// signature is reported as invalid rather than thrown.
+static JSValue verify_batch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t sigs_len, msgs_len, pubkeys_len;
+    uint8_t *sigs = NULL, *msgs = NULL, *pubkeys = NULL;
+
+    if (argc != 3) return JS_ThrowTypeError(ctx, "wrong number of arguments");
+
+    sigs = qjs_get_bytes(ctx, argv[0], &sigs_len);
+    if (!sigs || sigs_len % 64 != 0) return JS_ThrowTypeError(ctx, "invalid signatures format");
+    size_t count = sigs_len / 64;
+
+    msgs = qjs_get_bytes(ctx, argv[1], &msgs_len);
+    int msg_step = msgs ? batch_msg_step(msgs_len, count) : -1;
+    if (msg_step < 0) return JS_ThrowTypeError(ctx, "message hashes must be 32 bytes, or 32 bytes per signature");
+
+    pubkeys = qjs_get_bytes(ctx, argv[2], &pubkeys_len);
+    if (!pubkeys || pubkeys_len != count * sizeof(secp256k1_pubkey)) {
+        return JS_ThrowTypeError(ctx, "invalid public keys format");
+    }
+
+    // Allocated zeroed, so only the valid signatures need to be marked
+    JSValue result = JS_NewArrayBufferCopy(ctx, NULL, (count + 7) / 8);
+    if (JS_IsException(result)) return result;
+    size_t bitmap_len;
+    uint8_t *bitmap = JS_GetArrayBuffer(ctx, &bitmap_len, result);
+    const secp256k1_context *secp_ctx = get_context();
+
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_signature signature;
+    for (size_t i = 0; i < count; i++) {
+        if (!secp256k1_ecdsa_signature_parse_compact(secp_ctx, &signature, sigs + i * 64)) {
+            continue;
+        }
+        memcpy(&pubkey, pubkeys + i * sizeof(secp256k1_pubkey), sizeof(secp256k1_pubkey));
+        if (secp256k1_ecdsa_verify(secp_ctx, &signature, msgs + i * msg_step, &pubkey) == 1) {
+            bitmap[i / 8] |= 1 << (i % 8);
+        }
+    }
+    return result;
+}
+
+// recoverBatch(signatures, messageHashes) takes 65-byte signatures (64 bytes
+// followed by the recovery id, the layout of a secp256k1 witness lock) and
+// returns the recovered raw public keys packed in one ArrayBuffer of 64 bytes
+// each. The public key of a signature that can't be recovered is all zeros,
+// which is never a valid public key.
+static JSValue recover_batch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t sigs_len, msgs_len;
+    uint8_t *sigs = NULL, *msgs = NULL;
+
+    if (argc != 2) return JS_ThrowTypeError(ctx, "wrong number of arguments");
+
+    sigs = qjs_get_bytes(ctx, argv[0], &sigs_len);
+    if (!sigs || sigs_len % 65 != 0) return JS_ThrowTypeError(ctx, "invalid signatures format");
+    size_t count = sigs_len / 65;
+
+    msgs = qjs_get_bytes(ctx, argv[1], &msgs_len);
+    int msg_step = msgs ? batch_msg_step(msgs_len, count) : -1;
+    if (msg_step < 0) return JS_ThrowTypeError(ctx, "message hashes must be 32 bytes, or 32 bytes per signature");
+
+    JSValue result = JS_NewArrayBufferCopy(ctx, NULL, count * sizeof(secp256k1_pubkey));
+    if (JS_IsException(result)) return result;
+    size_t out_len;
+    uint8_t *out = JS_GetArrayBuffer(ctx, &out_len, result);
+    const secp256k1_context *secp_ctx = get_context();
+
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_recoverable_signature signature;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *sig = sigs + i * 65;
+        int recid = sig[64];
+        if (recid > 3 ||
+            !secp256k1_ecdsa_recoverable_signature_parse_compact(secp_ctx, &signature, sig, recid)) {
+            continue;
+        }
+        if (secp256k1_ecdsa_recover(secp_ctx, &pubkey, &signature, msgs + i * msg_step)) {
+            memcpy(out + i * sizeof(secp256k1_pubkey), pubkey.data, sizeof(pubkey));
+        }
+    }
+    return result;
+}
+
 static const JSCFunctionListEntry secp256k1_obj_funcs[] = {
     JS_CFUNC_DEF("recover", 3, recover),
     JS_CFUNC_DEF("serializePubkey", 2, serialize_pubkey),
     JS_CFUNC_DEF("parsePubkey", 1, parse_pubkey),
     JS_CFUNC_DEF("verify", 3, verify),
+    JS_CFUNC_DEF("verifyBatch", 3, verify_batch),
+    JS_CFUNC_DEF("recoverBatch", 2, recover_batch),
 };
 
 static JSValue schnorr_serialize_xonly_pubkey(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
@@ -180,7 +286,7 @@ static JSValue schnorr_serialize_xonly_pubkey(JSContext *ctx, JSValueConst this_
     if (argc != 1) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get public key from argument
-    pubkey_data = JS_GetArrayBuffer(ctx, &pubkey_len, argv[0]);
+    pubkey_data = qjs_get_bytes(ctx, argv[0], &pubkey_len);
     if (!pubkey_data || pubkey_len != sizeof(secp256k1_xonly_pubkey)) {
         return JS_ThrowTypeError(ctx, "invalid x-only public key format");
     }
@@ -194,7 +300,7 @@ static JSValue schnorr_serialize_xonly_pubkey(JSContext *ctx, JSValueConst this_
         return JS_ThrowOutOfMemory(ctx);
     }
 
-    if (!secp256k1_xonly_pubkey_serialize(g_secp256k1_context, output, &pubkey)) {
+    if (!secp256k1_xonly_pubkey_serialize(get_context(), output, &pubkey)) {
         js_free(ctx, output);
         return JS_ThrowInternalError(ctx, "serialization failed");
     }
@@ -210,11 +316,11 @@ static JSValue schnorr_tagged_sha256(JSContext *ctx, JSValueConst this_val, int
     if (argc != 2) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get tag from first argument
-    tag = JS_GetArrayBuffer(ctx, &tag_len, argv[0]);
+    tag = qjs_get_bytes(ctx, argv[0], &tag_len);
     if (!tag) return JS_ThrowTypeError(ctx, "invalid tag format");
 
     // Get message from second argument
-    msg = JS_GetArrayBuffer(ctx, &msg_len, argv[1]);
+    msg = qjs_get_bytes(ctx, argv[1], &msg_len);
     if (!msg) return JS_ThrowTypeError(ctx, "invalid message format");
 
     // Allocate output buffer for hash (32 bytes)
@@ -223,7 +329,7 @@ static JSValue schnorr_tagged_sha256(JSContext *ctx, JSValueConst this_val, int
         return JS_ThrowOutOfMemory(ctx);
     }
 
-    (void)secp256k1_tagged_sha256(g_secp256k1_context, output, tag, tag_len, msg, msg_len);
+    (void)secp256k1_tagged_sha256(get_context(), output, tag, tag_len, msg, msg_len);
 
     return JS_NewArrayBuffer(ctx, output, 32, free_array_buffer, ctx, false);
 }
@@ -237,13 +343,13 @@ static JSValue schnorr_parse_xonly_pubkey(JSContext *ctx, JSValueConst this_val,
     if (argc != 1) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get serialized x-only public key from argument
-    input = JS_GetArrayBuffer(ctx, &input_len, argv[0]);
+    input = qjs_get_bytes(ctx, argv[0], &input_len);
     if (!input || input_len != 32) {
         return JS_ThrowTypeError(ctx, "invalid x-only public key format (must be 32 bytes)");
     }
 
     // Parse the x-only public key
-    if (!secp256k1_xonly_pubkey_parse(g_secp256k1_context, &pubkey, input)) {
+    if (!secp256k1_xonly_pubkey_parse(get_context(), &pubkey, input)) {
         return JS_ThrowTypeError(ctx, "invalid x-only public key");
     }
 
@@ -260,15 +366,15 @@ static JSValue schnorr_verify(JSContext *ctx, JSValueConst this_val, int argc, J
     if (argc != 3) return JS_ThrowTypeError(ctx, "wrong number of arguments");
 
     // Get signature from first argument
-    sig = JS_GetArrayBuffer(ctx, &sig_len, argv[0]);
+    sig = qjs_get_bytes(ctx, argv[0], &sig_len);
     if (!sig || sig_len != 64) return JS_ThrowTypeError(ctx, "invalid signature format");
 
     // Get message from second argument
-    msg = JS_GetArrayBuffer(ctx, &msg_len, argv[1]);
+    msg = qjs_get_bytes(ctx, argv[1], &msg_len);
     if (!msg || msg_len != 32) return JS_ThrowTypeError(ctx, "message must be 32 bytes");
 
     // Get public key from third argument
-    pubkey_data = JS_GetArrayBuffer(ctx, &pubkey_len, argv[2]);
+    pubkey_data = qjs_get_bytes(ctx, argv[2], &pubkey_len);
     if (!pubkey_data || pubkey_len != sizeof(secp256k1_xonly_pubkey)) {
         return JS_ThrowTypeError(ctx, "invalid x-only public key format");
     }
@@ -277,16 +383,60 @@ static JSValue schnorr_verify(JSContext *ctx, JSValueConst this_val, int argc, J
     memcpy(&pubkey, pubkey_data, sizeof(secp256k1_xonly_pubkey));
 
     // Perform the verification
-    int result = secp256k1_schnorrsig_verify(g_secp256k1_context, sig, msg, msg_len, &pubkey);
+    int result = secp256k1_schnorrsig_verify(get_context(), sig, msg, msg_len, &pubkey);
 
     return JS_NewBool(ctx, result == 1);
 }
 
+// verifyBatch(signatures, messageHashes, xonlyPubkeys): one combined check for
+// the whole batch, falling back to one verification per signature only when it
+// fails, to tell which ones are invalid. Returns a bitmap like
+// secp256k1.verifyBatch.
+static JSValue schnorr_verify_batch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    size_t sigs_len, msgs_len, pubkeys_len;
+    uint8_t *sigs = NULL, *msgs = NULL, *pubkeys = NULL;
+
+    if (argc != 3) return JS_ThrowTypeError(ctx, "wrong number of arguments");
+
+    sigs = qjs_get_bytes(ctx, argv[0], &sigs_len);
+    if (!sigs || sigs_len % 64 != 0) return JS_ThrowTypeError(ctx, "invalid signatures format");
+    size_t count = sigs_len / 64;
+
+    msgs = qjs_get_bytes(ctx, argv[1], &msgs_len);
+    int msg_step = msgs ? batch_msg_step(msgs_len, count) : -1;
+    if (msg_step < 0) return JS_ThrowTypeError(ctx, "messages must be 32 bytes, or 32 bytes per signature");
+
+    pubkeys = qjs_get_bytes(ctx, argv[2], &pubkeys_len);
+    if (!pubkeys || pubkeys_len != count * sizeof(secp256k1_xonly_pubkey)) {
+        return JS_ThrowTypeError(ctx, "invalid x-only public keys format");
+    }
+
+    JSValue result = JS_NewArrayBufferCopy(ctx, NULL, (count + 7) / 8);
+    if (JS_IsException(result)) return result;
+    size_t bitmap_len;
+    uint8_t *bitmap = JS_GetArrayBuffer(ctx, &bitmap_len, result);
+    const secp256k1_context *secp_ctx = get_context();
+
+    // secp256k1_xonly_pubkey is a plain byte array, so the packed keys can be
+    // used in place
+    const secp256k1_xonly_pubkey *xonly_pubkeys = (const secp256k1_xonly_pubkey *)pubkeys;
+    bool all_valid =
+        count > 1 && secp256k1_schnorrsig_verify_batch(secp_ctx, sigs, msgs, msg_step, xonly_pubkeys, count) == 1;
+    for (size_t i = 0; i < count; i++) {
+        if (all_valid ||
+            secp256k1_schnorrsig_verify(secp_ctx, sigs + i * 64, msgs + i * msg_step, 32, &xonly_pubkeys[i]) == 1) {
+            bitmap[i / 8] |= 1 << (i % 8);
+        }
+    }
+    return result;
+}
+
 static const JSCFunctionListEntry schnorr_obj_funcs[] = {
     JS_CFUNC_DEF("serializeXonlyPubkey", 1, schnorr_serialize_xonly_pubkey),
     JS_CFUNC_DEF("taggedSha256", 2, schnorr_tagged_sha256),
     JS_CFUNC_DEF("parseXonlyPubkey", 1, schnorr_parse_xonly_pubkey),
     JS_CFUNC_DEF("verify", 3, schnorr_verify),
+    JS_CFUNC_DEF("verifyBatch", 3, schnorr_verify_batch),
 };
 
 int qjs_init_module_secp256k1_lazy(JSContext *ctx, JSModuleDef *m) {
@@ -304,7 +454,6 @@ int qjs_init_module_secp256k1_lazy(JSContext *ctx, JSModuleDef *m) {
 }
 
 int qjs_init_module_secp256k1(JSContext *js_ctx, JSModuleDef *m) {
-    g_secp256k1_context = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
     JS_AddModuleExport(js_ctx, m, "secp256k1");
     JS_AddModuleExport(js_ctx, m, "schnorr");
     return 0;
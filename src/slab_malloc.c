@@ -0,0 +1,285 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "cutils.h"
+#include "slab_malloc.h"
+
+// Blocks of up to SLAB_MAX_SIZE bytes are rounded up to a multiple of
+// SLAB_CLASS_STEP and carved from slabs of one size class each. A slab is a
+// page taken straight from the program break and handed out by bumping a
+// pointer; freed blocks go to a per-class free list and are reused first.
+// There are no headers, no splitting and no merging: the class of a block is
+// found from the page it lives in. Slab pages are never given back to malloc.
+#define SLAB_SIZE 4096
+#define SLAB_CLASS_STEP 16
+#define SLAB_MAX_SIZE 256
+#define SLAB_CLASS_COUNT (SLAB_MAX_SIZE / SLAB_CLASS_STEP)
+#define SLAB_PAGE_COUNT (CKB_MEMORY_LIMIT / SLAB_SIZE)
+
+// In arena mode, blocks of any size are bumped from chunks of the program
+// break and only the most recent ones are ever reclaimed. The arena stops
+// taking break once less than ARENA_RESERVE would be left below CKB_BRK_MAX,
+// so the binned allocators still have room to reuse freed blocks.
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_RESERVE (512 * 1024)
+#define ARENA_ALIGN 16
+
+// Owner of each page: malloc, the slab of a size class, or the arena
+#define PAGE_MALLOC 0
+#define PAGE_ARENA 0xFF
+
+// malloc_usable_size isn't available here, so like the default QuickJS
+// functions only a fixed overhead is counted per block. This keeps GC runs as
+// frequent as with the default allocator.
+#define SLAB_ACCOUNTED_SIZE 8
+
+typedef struct SlabFreeBlock {
+    struct SlabFreeBlock *next;
+} SlabFreeBlock;
+
+// Header in front of each arena block. The low bit of size marks a freed
+// block; prev links the blocks of the current chunk so that freed blocks at
+// the top can be popped.
+typedef struct ArenaBlock {
+    size_t size;
+    struct ArenaBlock *prev;
+} ArenaBlock;
+
+#define ARENA_FREED 1
+
+static struct {
+    SlabFreeBlock *free_lists[SLAB_CLASS_COUNT];
+    uint8_t *bump[SLAB_CLASS_COUNT];
+    uint8_t *bump_end[SLAB_CLASS_COUNT];
+    // PAGE_MALLOC, PAGE_ARENA or 1 + class of the slab occupying each page
+    uint8_t page_kind[SLAB_PAGE_COUNT];
+    bool arena_enabled;
+    uint8_t *arena_bump;
+    uint8_t *arena_end;
+    ArenaBlock *arena_last;
+} g_slab;
+
+static inline size_t slab_class_of_size(size_t size) { return size == 0 ? 0 : (size - 1) / SLAB_CLASS_STEP; }
+
+static inline size_t slab_class_size(size_t cls) { return (cls + 1) * SLAB_CLASS_STEP; }
+
+static inline uint8_t page_kind_of_ptr(const void *ptr) {
+    uintptr_t page = (uintptr_t)ptr / SLAB_SIZE;
+    if (page >= SLAB_PAGE_COUNT) return PAGE_MALLOC;
+    return g_slab.page_kind[page];
+}
+
+static void set_page_kind(uint8_t *start, size_t size, uint8_t kind) {
+    memset(&g_slab.page_kind[(uintptr_t)start / SLAB_SIZE], kind, size / SLAB_SIZE);
+}
+
+// Takes size bytes, a multiple of SLAB_SIZE, from the program break
+static uint8_t *break_alloc(size_t size) {
+    // Other users of the break keep it page aligned, but don't rely on it
+    uintptr_t brk = (uintptr_t)_sbrk(0);
+    size_t pad = -brk & (SLAB_SIZE - 1);
+    uint8_t *p = _sbrk(pad + size);
+    if (p == (void *)-1) return NULL;
+    return p + pad;
+}
+
+static uint8_t *slab_new(size_t cls) {
+    uint8_t *slab = break_alloc(SLAB_SIZE);
+    if (!slab) return NULL;
+    set_page_kind(slab, SLAB_SIZE, (uint8_t)(cls + 1));
+    g_slab.bump[cls] = slab;
+    g_slab.bump_end[cls] = slab + SLAB_SIZE;
+    return slab;
+}
+
+static void *slab_alloc(size_t cls) {
+    SlabFreeBlock *block = g_slab.free_lists[cls];
+    if (block) {
+        g_slab.free_lists[cls] = block->next;
+        return block;
+    }
+    size_t size = slab_class_size(cls);
+    if ((size_t)(g_slab.bump_end[cls] - g_slab.bump[cls]) < size && !slab_new(cls)) {
+        return NULL;
+    }
+    void *ptr = g_slab.bump[cls];
+    g_slab.bump[cls] += size;
+    return ptr;
+}
+
+static inline size_t arena_round(size_t size) { return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1); }
+
+// Makes room for at least size more bytes at the arena bump pointer. The chunk
+// is extended when the break still ends there, otherwise a new chunk starts
+// and blocks of the old one can no longer be popped. Turns arena mode off for
+// good once the break nears CKB_BRK_MAX.
+static bool arena_grow(size_t size) {
+    size_t chunk = (size + ARENA_CHUNK_SIZE - 1) & ~(size_t)(ARENA_CHUNK_SIZE - 1);
+    uintptr_t brk = (uintptr_t)_sbrk(0);
+    if (brk + chunk + SLAB_SIZE + ARENA_RESERVE > CKB_BRK_MAX) {
+        g_slab.arena_enabled = false;
+        return false;
+    }
+    uint8_t *p = break_alloc(chunk);
+    if (!p) {
+        g_slab.arena_enabled = false;
+        return false;
+    }
+    set_page_kind(p, chunk, PAGE_ARENA);
+    if (p != g_slab.arena_end) {
+        g_slab.arena_bump = p;
+        g_slab.arena_last = NULL;
+    }
+    g_slab.arena_end = p + chunk;
+    return true;
+}
+
+static void *arena_alloc(size_t size) {
+    size_t block_size = sizeof(ArenaBlock) + arena_round(size);
+    if ((size_t)(g_slab.arena_end - g_slab.arena_bump) < block_size && !arena_grow(block_size)) {
+        return NULL;
+    }
+    ArenaBlock *block = (ArenaBlock *)g_slab.arena_bump;
+    block->size = arena_round(size);
+    block->prev = g_slab.arena_last;
+    g_slab.arena_last = block;
+    g_slab.arena_bump += block_size;
+    return block + 1;
+}
+
+static inline ArenaBlock *arena_block_of_ptr(void *ptr) { return (ArenaBlock *)ptr - 1; }
+
+static void arena_free(void *ptr) {
+    ArenaBlock *block = arena_block_of_ptr(ptr);
+    block->size |= ARENA_FREED;
+    // Blocks below the top stay allocated until everything above them is freed
+    while (g_slab.arena_last && (g_slab.arena_last->size & ARENA_FREED)) {
+        g_slab.arena_bump = (uint8_t *)g_slab.arena_last;
+        g_slab.arena_last = g_slab.arena_last->prev;
+    }
+}
+
+// Resizes the block at the top of the arena in place, if there is room
+static bool arena_resize_last(void *ptr, size_t size) {
+    ArenaBlock *block = arena_block_of_ptr(ptr);
+    if (block != g_slab.arena_last) return false;
+    size_t new_size = arena_round(size);
+    uint8_t *new_bump = (uint8_t *)ptr + new_size;
+    if (new_bump > g_slab.arena_end) {
+        if (!g_slab.arena_enabled || !arena_grow(new_bump - g_slab.arena_end)) return false;
+        // A new chunk doesn't continue the block
+        if (block != g_slab.arena_last) return false;
+    }
+    block->size = new_size;
+    g_slab.arena_bump = new_bump;
+    return true;
+}
+
+static void *alloc_block(size_t size) {
+    if (g_slab.arena_enabled) {
+        void *ptr = arena_alloc(size);
+        if (ptr) {
+            MALLOC_STATS_ALLOC(sizeof(ArenaBlock) + arena_round(size));
+            return ptr;
+        }
+    }
+    if (size <= SLAB_MAX_SIZE) {
+        size_t cls = slab_class_of_size(size);
+        void *ptr = slab_alloc(cls);
+        // Out of break: malloc may still have a free chunk to reuse
+        if (ptr) {
+            MALLOC_STATS_ALLOC(slab_class_size(cls));
+            return ptr;
+        }
+    }
+    return malloc(size);
+}
+
+static void free_block(void *ptr) {
+    uint8_t kind = page_kind_of_ptr(ptr);
+    if (kind == PAGE_MALLOC) {
+        free(ptr);
+        return;
+    }
+    if (kind == PAGE_ARENA) {
+        MALLOC_STATS_FREE(sizeof(ArenaBlock) + arena_block_of_ptr(ptr)->size);
+        arena_free(ptr);
+        return;
+    }
+    MALLOC_STATS_FREE(slab_class_size(kind - 1));
+    SlabFreeBlock *block = (SlabFreeBlock *)ptr;
+    block->next = g_slab.free_lists[kind - 1];
+    g_slab.free_lists[kind - 1] = block;
+}
+
+static void *slab_js_malloc(JSMallocState *s, size_t size) {
+    if (unlikely(s->malloc_size + size > s->malloc_limit)) return NULL;
+    void *ptr = alloc_block(size);
+    if (!ptr) return NULL;
+    s->malloc_count++;
+    s->malloc_size += SLAB_ACCOUNTED_SIZE;
+    return ptr;
+}
+
+static void slab_js_free(JSMallocState *s, void *ptr) {
+    if (!ptr) return;
+    s->malloc_count--;
+    s->malloc_size -= SLAB_ACCOUNTED_SIZE;
+    free_block(ptr);
+}
+
+static void *slab_js_realloc(JSMallocState *s, void *ptr, size_t size) {
+    if (!ptr) {
+        if (size == 0) return NULL;
+        return slab_js_malloc(s, size);
+    }
+    if (size == 0) {
+        slab_js_free(s, ptr);
+        return NULL;
+    }
+    if (unlikely(s->malloc_size + size > s->malloc_limit)) return NULL;
+    uint8_t kind = page_kind_of_ptr(ptr);
+    size_t old_size;
+    if (kind == PAGE_MALLOC) {
+        // Blocks from malloc stay there, it can often grow them in place
+        return realloc(ptr, size);
+    } else if (kind == PAGE_ARENA) {
+        old_size = arena_block_of_ptr(ptr)->size;
+        if (arena_resize_last(ptr, size)) {
+            MALLOC_STATS_REALLOC(old_size, arena_block_of_ptr(ptr)->size, 1);
+            return ptr;
+        }
+    } else {
+        old_size = slab_class_size(kind - 1);
+    }
+    if (size <= old_size) {
+        MALLOC_STATS_REALLOC(old_size, old_size, 1);
+        return ptr;
+    }
+    void *new_ptr = alloc_block(size);
+    if (!new_ptr) return NULL;
+    MALLOC_STATS_REALLOC(old_size, size, 0);
+    memcpy(new_ptr, ptr, old_size);
+    free_block(ptr);
+    return new_ptr;
+}
+
+// QuickJS uses the slack of a block, e.g. to append to a string in place. The
+// size of blocks from malloc is unknown.
+static size_t slab_js_malloc_usable_size(const void *ptr) {
+    uint8_t kind = page_kind_of_ptr(ptr);
+    if (kind == PAGE_MALLOC) return 0;
+    if (kind == PAGE_ARENA) return ((const ArenaBlock *)ptr - 1)->size;
+    return slab_class_size(kind - 1);
+}
+
+const JSMallocFunctions qjs_slab_malloc_funcs = {
+    slab_js_malloc,
+    slab_js_free,
+    slab_js_realloc,
+    slab_js_malloc_usable_size,
+};
+
+void qjs_set_arena_malloc(bool enable) { g_slab.arena_enabled = enable; }
@@ -0,0 +1,20 @@
+#ifndef _SLAB_MALLOC_H_
+#define _SLAB_MALLOC_H_
+
+#include <stdbool.h>
+
+#include "quickjs.h"
+
+// QuickJS allocation functions serving small blocks (JSObject, JSString,
+// shapes, atoms, ...) from per-size-class slabs and larger ones from malloc.
+// Install them with JS_NewRuntime2(&qjs_slab_malloc_funcs, NULL).
+extern const JSMallocFunctions qjs_slab_malloc_funcs;
+
+// Arena mode, for scripts that run once and exit: from now on blocks of any
+// size are bumped from the program break and a freed block is only reclaimed
+// when it is at the top of the arena. Blocks allocated before keep their
+// owner. Once the break nears CKB_BRK_MAX the mode turns itself off and the
+// slabs and malloc take over.
+void qjs_set_arena_malloc(bool enable);
+
+#endif  // _SLAB_MALLOC_H_
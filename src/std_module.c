@@ -9,9 +9,22 @@
 #include "std_module.h"
 #include "ckb_syscall_apis.h"
 #include "ckb_cell_fs.h"
+#include "ckb_module.h"
 #include "qjs.h"
 #include "utils.h"
 
+#ifdef BOOT_PROFILE
+// Cycles spent compiling each module, and loading, linking and evaluating
+// each lazy module, printed in the same format as the boot phases.
+#define MODULE_PROFILE_START() uint64_t module_profile_start = ckb_current_cycles()
+#define MODULE_PROFILE_REPORT(kind, name)                     \
+    printf("[boot-profile] %s=%s cycles=%llu", kind, name, \
+           (unsigned long long)(ckb_current_cycles() - module_profile_start))
+#else
+#define MODULE_PROFILE_START()
+#define MODULE_PROFILE_REPORT(kind, name)
+#endif
+
 static JSValue js_print(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
     int i;
     const char *str;
@@ -65,19 +78,212 @@ void js_std_add_helpers(JSContext *ctx, int argc, const char *argv[]) {
     JS_FreeValue(ctx, global_obj);
 }
 
-uint8_t *js_load_file(JSContext *ctx, size_t *pbuf_len, const char *filename) {
-    FSFile *f = NULL;
+#define JS_REQUIRE_MAX_MODULES 8
 
-    int err = ckb_get_file(filename, &f);
-    if (err) {
-        return NULL;
+// C modules served by the global require(). Their namespace objects are built
+// on first use, without going through the parser.
+static struct {
+    const char *name;
+    JSModuleDef *m;
+} g_require_modules[JS_REQUIRE_MAX_MODULES];
+static size_t g_require_module_count = 0;
+
+int js_std_register_module(const char *name, JSModuleDef *m) {
+    if (g_require_module_count >= JS_REQUIRE_MAX_MODULES) {
+        return QJS_ERROR_INTERNAL;
     }
-    if (f->size == 0) {
-        return NULL;
+    g_require_modules[g_require_module_count].name = name;
+    g_require_modules[g_require_module_count].m = m;
+    g_require_module_count++;
+    return 0;
+}
+
+static bool g_lazy_modules = false;
+
+void js_std_set_lazy_modules(bool enable) { g_lazy_modules = enable; }
+
+// A file system module returned by require() in lazy mode. It stands for the
+// module namespace, but the module is only loaded, linked and evaluated when
+// one of its properties is first accessed.
+typedef struct {
+    char *basename;
+    char *filename;
+    JSValue ns;  // JS_UNDEFINED until loaded
+} JSLazyModule;
+
+static JSClassID js_lazy_module_class_id;
+
+static void js_lazy_module_finalizer(JSRuntime *rt, JSValue val) {
+    JSLazyModule *lm = JS_GetOpaque(val, js_lazy_module_class_id);
+    if (lm) {
+        js_free_rt(rt, lm->basename);
+        js_free_rt(rt, lm->filename);
+        JS_FreeValueRT(rt, lm->ns);
+        js_free_rt(rt, lm);
+    }
+}
+
+static void js_lazy_module_mark(JSRuntime *rt, JSValueConst val, JS_MarkFunc *mark_func) {
+    JSLazyModule *lm = JS_GetOpaque(val, js_lazy_module_class_id);
+    if (lm) {
+        JS_MarkValue(rt, lm->ns, mark_func);
+    }
+}
+
+// Returns the namespace of the lazy module (not duplicated), loading it first
+// if needed.
+static JSValue js_lazy_module_namespace(JSContext *ctx, JSValueConst obj) {
+    JSLazyModule *lm = JS_GetOpaque(obj, js_lazy_module_class_id);
+    if (!JS_IsUndefined(lm->ns)) {
+        return lm->ns;
     }
+    MODULE_PROFILE_START();
+    JSModuleDef *m = JS_RunModule(ctx, lm->basename, lm->filename);
+    if (!m) return JS_EXCEPTION;
+    JSValue ns = JS_GetModuleNamespace(ctx, m);
+    if (JS_IsException(ns)) return JS_EXCEPTION;
+    lm->ns = ns;
+    MODULE_PROFILE_REPORT("lazy_module", lm->filename);
+    return ns;
+}
+
+static int js_lazy_module_get_own_property(JSContext *ctx, JSPropertyDescriptor *desc, JSValueConst obj,
+                                           JSAtom prop) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_GetOwnProperty(ctx, desc, ns, prop);
+}
+
+static int js_lazy_module_get_own_property_names(JSContext *ctx, JSPropertyEnum **ptab, uint32_t *plen,
+                                                 JSValueConst obj) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_GetOwnPropertyNames(ctx, ptab, plen, ns, JS_GPN_STRING_MASK | JS_GPN_SYMBOL_MASK);
+}
+
+static int js_lazy_module_delete_property(JSContext *ctx, JSValueConst obj, JSAtom prop) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_DeleteProperty(ctx, ns, prop, 0);
+}
+
+static int js_lazy_module_define_own_property(JSContext *ctx, JSValueConst obj, JSAtom prop, JSValueConst val,
+                                              JSValueConst getter, JSValueConst setter, int flags) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_DefineProperty(ctx, ns, prop, val, getter, setter, flags);
+}
+
+static int js_lazy_module_has_property(JSContext *ctx, JSValueConst obj, JSAtom atom) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_HasProperty(ctx, ns, atom);
+}
+
+static JSValue js_lazy_module_get_property(JSContext *ctx, JSValueConst obj, JSAtom atom, JSValueConst receiver) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return JS_EXCEPTION;
+    return JS_GetProperty(ctx, ns, atom);
+}
+
+static int js_lazy_module_set_property(JSContext *ctx, JSValueConst obj, JSAtom atom, JSValueConst value,
+                                       JSValueConst receiver, int flags) {
+    JSValue ns = js_lazy_module_namespace(ctx, obj);
+    if (JS_IsException(ns)) return -1;
+    return JS_SetProperty(ctx, ns, atom, JS_DupValue(ctx, value));
+}
+
+static JSClassExoticMethods js_lazy_module_exotic = {
+    .get_own_property = js_lazy_module_get_own_property,
+    .get_own_property_names = js_lazy_module_get_own_property_names,
+    .delete_property = js_lazy_module_delete_property,
+    .define_own_property = js_lazy_module_define_own_property,
+    .has_property = js_lazy_module_has_property,
+    .get_property = js_lazy_module_get_property,
+    .set_property = js_lazy_module_set_property,
+};
+
+static JSClassDef js_lazy_module_class = {
+    "LazyModule",
+    .finalizer = js_lazy_module_finalizer,
+    .gc_mark = js_lazy_module_mark,
+    .exotic = &js_lazy_module_exotic,
+};
+
+static JSValue js_new_lazy_module(JSContext *ctx, const char *filename) {
+    JSValue obj = JS_NewObjectClass(ctx, js_lazy_module_class_id);
+    if (JS_IsException(obj)) return obj;
+    JSLazyModule *lm = js_mallocz(ctx, sizeof(*lm));
+    if (!lm) goto fail;
+    lm->ns = JS_UNDEFINED;
+    JS_SetOpaque(obj, lm);
+
+    // relative names are resolved against the module calling require()
+    JSAtom basename_atom = JS_GetScriptOrModuleName(ctx, 1);
+    const char *basename = basename_atom == JS_ATOM_NULL ? NULL : JS_AtomToCString(ctx, basename_atom);
+    JS_FreeAtom(ctx, basename_atom);
+    lm->basename = js_strdup(ctx, basename ? basename : "");
+    JS_FreeCString(ctx, basename);
+    lm->filename = js_strdup(ctx, filename);
+    if (!lm->basename || !lm->filename) goto fail;
+    return obj;
 
-    *pbuf_len = f->size;
-    return (uint8_t *)f->content;
+fail:
+    JS_FreeValue(ctx, obj);
+    return JS_EXCEPTION;
+}
+
+static JSValue js_require(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv) {
+    const char *name = JS_ToCString(ctx, argv[0]);
+    if (!name) return JS_EXCEPTION;
+    for (size_t i = 0; i < g_require_module_count; i++) {
+        if (strcmp(name, g_require_modules[i].name) == 0) {
+            JS_FreeCString(ctx, name);
+            return JS_GetModuleNamespace(ctx, g_require_modules[i].m);
+        }
+    }
+    JSValue ret;
+    if (g_lazy_modules) {
+        ret = js_new_lazy_module(ctx, name);
+    } else {
+        // A plain Error, as thrown by the former JS require script
+        char message[256];
+        snprintf(message, sizeof(message), "cannot find the module: %s", name);
+        ret = JS_NewError(ctx);
+        if (!JS_IsException(ret)) {
+            JS_DefinePropertyValueStr(ctx, ret, "message", JS_NewString(ctx, message),
+                                      JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE);
+            ret = JS_Throw(ctx, ret);
+        }
+    }
+    JS_FreeCString(ctx, name);
+    return ret;
+}
+
+int js_std_add_require(JSContext *ctx) {
+    JS_NewClassID(&js_lazy_module_class_id);
+    JS_NewClass(JS_GetRuntime(ctx), js_lazy_module_class_id, &js_lazy_module_class);
+
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    // globalThis.__ckb_module is kept for scripts written against the former
+    // JS require script, which assigned it as a plain writable property. It is
+    // the namespace of the first registered module.
+    JSValue ckb_module = JS_UNDEFINED;
+    if (g_require_module_count > 0) {
+        ckb_module = JS_GetModuleNamespace(ctx, g_require_modules[0].m);
+        if (JS_IsException(ckb_module)) {
+            JS_FreeValue(ctx, global_obj);
+            return QJS_ERROR_INTERNAL;
+        }
+    }
+    int ret = JS_DefinePropertyValueStr(ctx, global_obj, "__ckb_module", ckb_module, JS_PROP_C_W_E);
+    if (ret < 0) {
+        JS_FreeValue(ctx, global_obj);
+        return QJS_ERROR_INTERNAL;
+    }
+    ret = JS_SetPropertyStr(ctx, global_obj, "require", JS_NewCFunction(ctx, js_require, "require", 1));
+    JS_FreeValue(ctx, global_obj);
+    return ret < 0 ? QJS_ERROR_INTERNAL : 0;
 }
 
 int js_module_set_import_meta(JSContext *ctx, JSValueConst func_val, JS_BOOL use_realpath, JS_BOOL is_main) {
@@ -107,42 +313,101 @@ int js_module_set_import_meta(JSContext *ctx, JSValueConst func_val, JS_BOOL use
     return 0;
 }
 
+bool js_is_snapshot(const uint8_t *buf, size_t buf_len) {
+    if (buf_len < sizeof(QJSSnapshotHeader)) {
+        return false;
+    }
+    const QJSSnapshotHeader *header = (const QJSSnapshotHeader *)buf;
+    return header->magic == QJS_SNAPSHOT_MAGIC;
+}
+
+// Snapshots mapped so far. Mapping patches the image, so it can't be read
+// again: later reads of the same image get the function read the first time.
+typedef struct MappedSnapshot {
+    const uint8_t *buf;
+    JSValue val;
+    struct MappedSnapshot *next;
+} MappedSnapshot;
+
+static MappedSnapshot *g_mapped_snapshots = NULL;
+
+JSValue js_read_snapshot(JSContext *ctx, uint8_t *buf, size_t buf_len) {
+    QJSSnapshotHeader *header = (QJSSnapshotHeader *)buf;
+    if (header->version != QJS_SNAPSHOT_VERSION || header->bc_version != BC_VERSION) {
+        return JS_ThrowSyntaxError(ctx, "invalid snapshot version");
+    }
+    if (header->bytecode_offset < sizeof(QJSSnapshotHeader) || header->bytecode_offset > buf_len ||
+        header->bytecode_length > buf_len - header->bytecode_offset) {
+        return JS_ThrowSyntaxError(ctx, "invalid snapshot layout");
+    }
+    if (header->mapped) {
+        for (MappedSnapshot *snapshot = g_mapped_snapshots; snapshot != NULL; snapshot = snapshot->next) {
+            if (snapshot->buf == buf) {
+                return JS_DupValue(ctx, snapshot->val);
+            }
+        }
+        // the first read failed half way
+        return JS_ThrowSyntaxError(ctx, "snapshot is already mapped");
+    }
+    uint8_t *bytecode = buf + header->bytecode_offset;
+    // Only memory that stays alive for the whole run can be mapped. Anything
+    // else is deserialized like plain bytecode.
+    if (!qjs_is_code_region(buf, buf_len)) {
+        return JS_ReadObject(ctx, bytecode, header->bytecode_length, JS_READ_OBJ_BYTECODE);
+    }
+    header->mapped = 1;
+    JSValue val = JS_ReadObject(ctx, bytecode, header->bytecode_length, JS_READ_OBJ_BYTECODE | JS_READ_OBJ_IN_PLACE);
+    if (JS_IsException(val)) {
+        return val;
+    }
+    // Kept until exit, like the code region
+    MappedSnapshot *snapshot = js_malloc(ctx, sizeof(MappedSnapshot));
+    if (snapshot == NULL) {
+        JS_FreeValue(ctx, val);
+        return JS_EXCEPTION;
+    }
+    snapshot->buf = buf;
+    snapshot->val = JS_DupValue(ctx, val);
+    snapshot->next = g_mapped_snapshots;
+    g_mapped_snapshots = snapshot;
+    return val;
+}
+
+// QuickJS keeps loaded modules by normalized name, so this runs once per
+// module. The source is borrowed from the mounted file system, which also acts
+// as the source cache keyed by path.
 JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, void *opaque) {
     JSModuleDef *m;
-
-    size_t buf_len;
-    uint8_t *buf;
     JSValue func_val;
 
-    buf = js_load_file(ctx, &buf_len, module_name);
-    if (!buf) {
-        if (strlen(module_name) <= 3) {
-            JS_ThrowReferenceError(ctx, "could not load module filename '%s'", module_name);
-            return NULL;
-        }
-        if (strcmp(module_name + strlen(module_name) - 3, ".js") != 0) {
-            JS_ThrowReferenceError(ctx, "could not load module filename '%s'", module_name);
-            return NULL;
-        }
-        char secend_name[256];
-        strcpy(secend_name, module_name);
-        strcpy(secend_name + strlen(module_name) - 3, ".bc");
-        buf = js_load_file(ctx, &buf_len, secend_name);
-        if (!buf) {
-            JS_ThrowReferenceError(ctx, "could not load module filename '%s'", module_name);
-            return NULL;
-        }
+    FSFile *file = NULL;
+    if (ckb_get_module_file(module_name, &file) != 0) {
+        JS_ThrowReferenceError(ctx, "could not load module filename '%s'", module_name);
+        return NULL;
+    }
+    if (file->size == 0) {
+        ckb_release_file(file);
+        JS_ThrowReferenceError(ctx, "could not load module filename '%s'", module_name);
+        return NULL;
     }
+    uint8_t *buf = (uint8_t *)file->content;
+    size_t buf_len = file->size;
 
-    if (((const char *)buf)[0] == (char)BC_VERSION) {
+    MODULE_PROFILE_START();
+    if (js_is_snapshot(buf, buf_len)) {
+        func_val = js_read_snapshot(ctx, buf, buf_len);
+    } else if (((const char *)buf)[0] == (char)BC_VERSION) {
         func_val = JS_ReadObject(ctx, buf, buf_len, JS_READ_OBJ_BYTECODE);
     } else {
         /* compile the module */
         func_val = JS_Eval(ctx, (char *)buf, buf_len, module_name, JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
     }
 
-    // js_free(ctx, buf);
+    // The compiled module doesn't refer to its source any more: snapshots are
+    // only mapped from the code region, never from a decompressed copy.
+    ckb_release_file(file);
     if (JS_IsException(func_val)) return NULL;
+    MODULE_PROFILE_REPORT("module", module_name);
     /* XXX: could propagate the exception */
     js_module_set_import_meta(ctx, func_val, TRUE, FALSE);
     /* the module is already referenced, so we must free it */
@@ -2,12 +2,30 @@
 #define _STD_MODULE_H_
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 #include "quickjs.h"
 
 void js_std_add_helpers(JSContext *ctx, int argc, const char *argv[]);
-uint8_t *js_load_file(JSContext *ctx, size_t *pbuf_len, const char *filename);
+/**
+ * Registers a C module so that the global `require(name)` can return its
+ * namespace object. Up to 8 modules can be registered.
+ */
+int js_std_register_module(const char *name, JSModuleDef *m);
+/**
+ * Installs `require` and `__ckb_module` on globalThis natively, replacing the
+ * JS require script.
+ */
+int js_std_add_require(JSContext *ctx);
+/**
+ * In lazy mode, `require(path)` also accepts file system modules. It returns a
+ * stand-in for the module namespace; the module is loaded, linked and
+ * evaluated on first property access.
+ */
+void js_std_set_lazy_modules(bool enable);
 int js_module_set_import_meta(JSContext *ctx, JSValueConst func_val, JS_BOOL use_realpath, JS_BOOL is_main);
+bool js_is_snapshot(const uint8_t *buf, size_t buf_len);
+JSValue js_read_snapshot(JSContext *ctx, uint8_t *buf, size_t buf_len);
 JSModuleDef *js_module_loader(JSContext *ctx, const char *module_name, void *opaque);
 
 static int js_module_dummy_init(JSContext *ctx, JSModuleDef *m);
@@ -62,3 +62,24 @@ JSValue qjs_create_uint8_array(JSContext *ctx, const uint8_t *data, size_t lengt
 
     return array;
 }
+
+JSValue qjs_create_uint32_array(JSContext *ctx, const uint32_t *data, size_t count) {
+    JSValue buffer = JS_NewArrayBufferCopy(ctx, (const uint8_t *)data, count * sizeof(uint32_t));
+    if (JS_IsException(buffer)) {
+        return JS_EXCEPTION;
+    }
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue constructor = JS_GetPropertyStr(ctx, global, "Uint32Array");
+    JSValue array = JS_CallConstructor(ctx, constructor, 1, &buffer);
+
+    JS_FreeValue(ctx, global);
+    JS_FreeValue(ctx, constructor);
+    JS_FreeValue(ctx, buffer);
+
+    return array;
+}
+
+uint8_t *qjs_get_bytes(JSContext *ctx, JSValueConst val, size_t *len) {
+    return JS_GetArrayBufferView(ctx, len, val);
+}
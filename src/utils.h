@@ -8,10 +8,18 @@
 #include "quickjs.h"
 #include "cutils.h"
 
+// An omitted optional offset, length or field argument
+#define NO_VALUE ((size_t)-1)
+
 bool qjs_bad_int_arg(JSContext *ctx, JSValue val, int index);
 bool qjs_bad_bigint_arg(JSContext *ctx, JSValue val, int index);
 bool qjs_bad_str_arg(JSContext *ctx, JSValue val, int index);
 void qjs_dbuf_init(JSContext *ctx, DynBuf *s);
 JSValue qjs_create_uint8_array(JSContext *ctx, const uint8_t *data, size_t length);
+JSValue qjs_create_uint32_array(JSContext *ctx, const uint32_t *data, size_t count);
+// Bytes of an ArrayBuffer, or the bytes viewed by a TypedArray or DataView
+// (honoring its byteOffset and byteLength), without copying. Returns NULL
+// without throwing for any other value or a detached buffer.
+uint8_t *qjs_get_bytes(JSContext *ctx, JSValueConst val, size_t *len);
 
 #endif
@@ -0,0 +1,186 @@
+// Boot cost benchmark: lots of declarations, almost nothing executed.
+// Compare the total cycles of the .js, .bc and .snap forms of this file.
+import * as ckb from "@ckb-js-std/bindings";
+
+function hexFrom(bytes) {
+    const chars = "0123456789abcdef";
+    let out = "0x";
+    for (const b of new Uint8Array(bytes)) {
+        out += chars[b >> 4] + chars[b & 15];
+    }
+    return out;
+}
+
+function bytesFrom(hex) {
+    const start = hex.startsWith("0x") ? 2 : 0;
+    const out = new Uint8Array((hex.length - start) / 2);
+    for (let i = 0; i < out.length; i++) {
+        out[i] = parseInt(hex.substr(start + i * 2, 2), 16);
+    }
+    return out.buffer;
+}
+
+class Codec {
+    constructor(name, byteLength, encode, decode) {
+        this.name = name;
+        this.byteLength = byteLength;
+        this.encode = encode;
+        this.decode = decode;
+    }
+    isFixedSize() {
+        return this.byteLength !== undefined;
+    }
+    map({ inMap, outMap }) {
+        return new Codec(
+            this.name,
+            this.byteLength,
+            (value) => this.encode(inMap ? inMap(value) : value),
+            (buffer) => (outMap ? outMap(this.decode(buffer)) : this.decode(buffer)),
+        );
+    }
+}
+
+function uint(byteLength, littleEndian = true) {
+    return new Codec(
+        `Uint${byteLength * 8}`,
+        byteLength,
+        (value) => {
+            const out = new Uint8Array(byteLength);
+            let v = BigInt(value);
+            for (let i = 0; i < byteLength; i++) {
+                out[littleEndian ? i : byteLength - 1 - i] = Number(v & 0xffn);
+                v >>= 8n;
+            }
+            return out.buffer;
+        },
+        (buffer) => {
+            const bytes = new Uint8Array(buffer);
+            let v = 0n;
+            for (let i = byteLength - 1; i >= 0; i--) {
+                v = (v << 8n) | BigInt(bytes[littleEndian ? i : byteLength - 1 - i]);
+            }
+            return v;
+        },
+    );
+}
+
+const Uint8 = uint(1);
+const Uint16 = uint(2);
+const Uint32 = uint(4);
+const Uint64 = uint(8);
+const Uint128 = uint(16);
+const Uint256 = uint(32);
+const Byte32 = new Codec("Byte32", 32, bytesFrom, hexFrom);
+
+function struct(name, fields) {
+    const keys = Object.keys(fields);
+    const byteLength = keys.reduce((sum, key) => sum + fields[key].byteLength, 0);
+    return new Codec(
+        name,
+        byteLength,
+        (value) => {
+            const out = new Uint8Array(byteLength);
+            let offset = 0;
+            for (const key of keys) {
+                out.set(new Uint8Array(fields[key].encode(value[key])), offset);
+                offset += fields[key].byteLength;
+            }
+            return out.buffer;
+        },
+        (buffer) => {
+            const result = {};
+            let offset = 0;
+            for (const key of keys) {
+                const size = fields[key].byteLength;
+                result[key] = fields[key].decode(buffer.slice(offset, offset + size));
+                offset += size;
+            }
+            return result;
+        },
+    );
+}
+
+function table(name, fields) {
+    const keys = Object.keys(fields);
+    return new Codec(
+        name,
+        undefined,
+        (value) => {
+            const parts = keys.map((key) => new Uint8Array(fields[key].encode(value[key])));
+            const headerLength = 4 + 4 * keys.length;
+            const total = parts.reduce((sum, part) => sum + part.length, headerLength);
+            const out = new Uint8Array(total);
+            const view = new DataView(out.buffer);
+            view.setUint32(0, total, true);
+            let offset = headerLength;
+            parts.forEach((part, i) => {
+                view.setUint32(4 + i * 4, offset, true);
+                out.set(part, offset);
+                offset += part.length;
+            });
+            return out.buffer;
+        },
+        (buffer) => {
+            const view = new DataView(buffer);
+            const total = view.getUint32(0, true);
+            const result = {};
+            keys.forEach((key, i) => {
+                const start = view.getUint32(4 + i * 4, true);
+                const end = i + 1 < keys.length ? view.getUint32(8 + i * 4, true) : total;
+                result[key] = fields[key].decode(buffer.slice(start, end));
+            });
+            return result;
+        },
+    );
+}
+
+const Bytes = new Codec(
+    "Bytes",
+    undefined,
+    (value) => {
+        const bytes = new Uint8Array(bytesFrom(value));
+        const out = new Uint8Array(4 + bytes.length);
+        new DataView(out.buffer).setUint32(0, bytes.length, true);
+        out.set(bytes, 4);
+        return out.buffer;
+    },
+    (buffer) => hexFrom(buffer.slice(4)),
+);
+
+const OutPoint = struct("OutPoint", { txHash: Byte32, index: Uint32 });
+const CellInput = struct("CellInput", { since: Uint64, previousOutput: OutPoint });
+const Script = table("Script", { codeHash: Byte32, hashType: Uint8, args: Bytes });
+const CellOutput = table("CellOutput", { capacity: Uint64, lock: Script, type: Script });
+const WitnessArgs = table("WitnessArgs", { lock: Bytes, inputType: Bytes, outputType: Bytes });
+const Header = struct("RawHeader", {
+    version: Uint32,
+    compactTarget: Uint32,
+    timestamp: Uint64,
+    number: Uint64,
+    epoch: Uint64,
+    parentHash: Byte32,
+    transactionsRoot: Byte32,
+    proposalsHash: Byte32,
+    extraHash: Byte32,
+    dao: Byte32,
+    nonce: Uint128,
+});
+
+export const codecs = {
+    Uint8,
+    Uint16,
+    Uint32,
+    Uint64,
+    Uint128,
+    Uint256,
+    Byte32,
+    Bytes,
+    OutPoint,
+    CellInput,
+    Script,
+    CellOutput,
+    WitnessArgs,
+    Header,
+};
+
+console.log(`boot finished at ${ckb.currentCycles()} cycles`);
@@ -0,0 +1,44 @@
+// Schnorr verification cost: one verify call per signature against a single
+// verifyBatch call, for growing numbers of signatures.
+import * as ckb from "@ckb-js-std/bindings";
+
+const SIG = ckb.hex.decode(
+    '52420fa2807eac7336c15ec7db76b41c3247f8457a1533bd783378e563cb33c43e5a8b17e91badaa290c02d3f8ce50df130c9d09c90c288d9d2be0e5976a5354');
+const MSG = ckb.hex.decode('1bd69c075dd7b78c4f20a698b22a3fb9d7461525c39827d6aaf7a1628be0a283');
+const PUBKEY = ckb.schnorr.parseXonlyPubkey(
+    ckb.hex.decode('2504ea5763b6d7a51b50dbf5871e50f195b3e0297fe6272334be555d3e5231a6'));
+
+function pack(item, n) {
+    const out = new Uint8Array(item.byteLength * n);
+    for (let i = 0; i < n; i++) {
+        out.set(new Uint8Array(item), i * item.byteLength);
+    }
+    return out;
+}
+
+function bench(n) {
+    const sigs = pack(SIG, n);
+    const pubkeys = pack(PUBKEY, n);
+
+    let start = ckb.currentCycles();
+    for (let i = 0; i < n; i++) {
+        if (!ckb.schnorr.verify(sigs.subarray(i * 64, i * 64 + 64), MSG, pubkeys.subarray(i * 64, i * 64 + 64))) {
+            throw new Error("verify failed");
+        }
+    }
+    const single = ckb.currentCycles() - start;
+
+    start = ckb.currentCycles();
+    const bitmap = new Uint8Array(ckb.schnorr.verifyBatch(sigs, MSG, pubkeys));
+    const batch = ckb.currentCycles() - start;
+    if (bitmap.some((b, i) => b !== (i * 8 + 8 <= n ? 0xff : (1 << (n % 8)) - 1))) {
+        throw new Error("verifyBatch failed");
+    }
+
+    console.log(`schnorr ${n} signatures: verify ${Math.round(single / 1024)} K cycles, ` +
+        `verifyBatch ${Math.round(batch / 1024)} K cycles (${Math.round(batch / n / 1024)} K per signature)`);
+}
+
+for (const n of [1, 4, 16, 64]) {
+    bench(n);
+}
@@ -0,0 +1,34 @@
+// Cycles per signature operation, to compare the build variants of `make variants`
+// (see benchmark-variants in the top level Makefile).
+import * as ckb from "@ckb-js-std/bindings";
+
+const ROUNDS = 8;
+
+const ECDSA_SIG = ckb.hex.decode(
+    '76e6d0e5ea61b46fe10443fe5b4d1bc6ce2d0d49d55e810312f7c22702e0548a' +
+    '3969ce72940a34632f93ebd1b8d591c3775428f035c6577e4adf8068b04819f0');
+const ECDSA_MSG = ckb.hex.decode('6a0024347e28905e2587c4c7598332a39ba6684bb6b74653511656a02bd20edb');
+const ECDSA_PUBKEY = ckb.hex.decode(
+    'aca98c5822b997c15f8c974386a11b14a0d009a4d5156e145644573e82ef7e7b' +
+    '226b9eb6173d6b4504606eb8d9558bde98d12100836e92d306a40f337ed8a0f3');
+const SCHNORR_SIG = ckb.hex.decode(
+    '52420fa2807eac7336c15ec7db76b41c3247f8457a1533bd783378e563cb33c4' +
+    '3e5a8b17e91badaa290c02d3f8ce50df130c9d09c90c288d9d2be0e5976a5354');
+const SCHNORR_MSG = ckb.hex.decode('1bd69c075dd7b78c4f20a698b22a3fb9d7461525c39827d6aaf7a1628be0a283');
+const SCHNORR_PUBKEY = ckb.schnorr.parseXonlyPubkey(
+    ckb.hex.decode('2504ea5763b6d7a51b50dbf5871e50f195b3e0297fe6272334be555d3e5231a6'));
+
+function bench(name, func) {
+    const start = ckb.currentCycles();
+    for (let i = 0; i < ROUNDS; i++) {
+        if (!func()) {
+            throw new Error(`${name} failed`);
+        }
+    }
+    const cycles = ckb.currentCycles() - start;
+    console.log(`${name}: ${Math.round(cycles / ROUNDS / 1024)} K cycles`);
+}
+
+bench("secp256k1.verify", () => ckb.secp256k1.verify(ECDSA_SIG, ECDSA_MSG, ECDSA_PUBKEY));
+bench("secp256k1.recover", () => ckb.secp256k1.recover(ECDSA_SIG, 1, ECDSA_MSG).byteLength === 64);
+bench("schnorr.verify", () => ckb.schnorr.verify(SCHNORR_SIG, SCHNORR_MSG, SCHNORR_PUBKEY));
@@ -0,0 +1,349 @@
+// Cycles per byte of the libc string functions, run with `make benchmark-string`.
+// Every function is first checked against a byte loop; any mismatch is printed
+// and the program fails before timing anything.
+// Each timed case works on size bytes starting align bytes into a word aligned
+// buffer; the other operand, where there is one, is word aligned.
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "ckb_syscall_apis.h"
+
+#define BENCH_ROUNDS 16
+#define BENCH_MAX_SIZE 4096
+
+// Checked buffers have up to 7 bytes of misalignment before and a guard after
+#define CHECK_GUARD 16
+#define CHECK_SMALL_SIZE 64
+
+static uint64_t g_src_words[BENCH_MAX_SIZE / 8 + 4];
+static uint64_t g_dst_words[BENCH_MAX_SIZE / 8 + 4];
+static unsigned char *const g_src = (unsigned char *)g_src_words;
+static unsigned char *const g_dst = (unsigned char *)g_dst_words;
+
+static const size_t g_sizes[] = {8, 64, 512, 4096};
+static const size_t g_aligns[] = {0, 1, 4};
+
+static volatile size_t g_sink;
+
+// src holds size non-zero bytes at align followed by a zero, dst the same
+// bytes at 0, so string scans and comparisons run to the end
+static void bench_setup(size_t size, size_t align) {
+    memset(g_src_words, 0, sizeof(g_src_words));
+    memset(g_dst_words, 0, sizeof(g_dst_words));
+    for (size_t i = 0; i < size; i++) {
+        g_src[align + i] = g_dst[i] = (unsigned char)('a' + i % 26);
+    }
+}
+
+static size_t bench_strlen(size_t size, size_t align) { return strlen((char *)g_src + align); }
+
+static size_t bench_memchr(size_t size, size_t align) { return (size_t)memchr(g_src + align, 0, size + 1); }
+
+static size_t bench_memcmp(size_t size, size_t align) { return (size_t)memcmp(g_src + align, g_dst, size); }
+
+static size_t bench_strcmp(size_t size, size_t align) { return (size_t)strcmp((char *)g_src + align, (char *)g_dst); }
+
+static size_t bench_memcpy(size_t size, size_t align) { return (size_t)memcpy(g_dst, g_src + align, size); }
+
+static size_t bench_memset(size_t size, size_t align) { return (size_t)memset(g_src + align, 'a', size); }
+
+// Reference versions. This file is built with -fno-builtin, so the compiler
+// doesn't turn these loops back into calls to the functions they check.
+static size_t ref_strlen(const unsigned char *s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+static const unsigned char *ref_memchr(const unsigned char *s, int c, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == (unsigned char)c) return s + i;
+    }
+    return NULL;
+}
+
+static const unsigned char *ref_strchr(const unsigned char *s, int c) {
+    for (;; s++) {
+        if (*s == (unsigned char)c) return s;
+        if (!*s) return NULL;
+    }
+}
+
+static int ref_memcmp(const unsigned char *l, const unsigned char *r, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (l[i] != r[i]) return l[i] < r[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static int ref_strcmp(const unsigned char *l, const unsigned char *r) {
+    for (; *l && *l == *r; l++, r++);
+    return *l == *r ? 0 : *l < *r ? -1 : 1;
+}
+
+static int sign(int v) { return (v > 0) - (v < 0); }
+
+// Sizes 0 to CHECK_SMALL_SIZE put a zero, match or difference in every byte of
+// a word at every alignment; the large ones cross many words and unrolled loops.
+static const size_t g_check_large_sizes[] = {100, 255, 1027};
+#define CHECK_SIZE_COUNT (CHECK_SMALL_SIZE + 1 + sizeof(g_check_large_sizes) / sizeof(g_check_large_sizes[0]))
+
+static size_t check_size(size_t i) {
+    return i <= CHECK_SMALL_SIZE ? i : g_check_large_sizes[i - CHECK_SMALL_SIZE - 1];
+}
+
+// Every position of the small sizes, the first and last words of the large ones
+static bool check_position(size_t size, size_t pos) {
+    return size <= CHECK_SMALL_SIZE || pos < CHECK_GUARD || pos + CHECK_GUARD >= size;
+}
+
+// Searched bytes: zero, one with the high bit set and a letter
+static const int g_check_chars[] = {0, 0x80, 'a'};
+
+// Non-zero bytes that aren't c, chosen to trip zero byte tricks that only hold
+// for ASCII (0x80, 0x81, 0xff) or that borrow across bytes (0x01). Byte i of
+// buf is always the same, so a few bytes are restored by filling them again.
+static void check_fill(unsigned char *buf, size_t from, size_t to, int c) {
+    static const unsigned char bytes[] = {0x01, 0x80, 0xff, 0x7f, 'a', 0xfe, 0x81, 0x7e};
+    for (size_t i = from; i < to; i++) {
+        unsigned char b = bytes[i % sizeof(bytes)];
+        buf[i] = b == (unsigned char)c ? 0x01 : b;
+    }
+}
+
+// Restores the bytes a case changed at pos and right after it, within size
+static void check_restore(unsigned char *buf, size_t size, size_t pos, int c) {
+    check_fill(buf, pos, pos + 2 < size ? pos + 2 : size, c);
+}
+
+static int g_failures;
+
+static void check_fail(const char *name, size_t size, size_t align, size_t other, size_t pos) {
+    if (g_failures++ < 16) {
+        printf("%s mismatch size=%d align=%d other=%d pos=%d\n", name, (int)size, (int)align, (int)other, (int)pos);
+    }
+}
+
+static void check_strlen(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t align = 0; align < 8; align++) {
+            check_fill(g_src, 0, align + size + CHECK_GUARD, 0);
+            g_src[align + size] = 0;
+            if (strlen((char *)g_src + align) != ref_strlen(g_src + align)) {
+                check_fail("strlen", size, align, 0, size);
+            }
+        }
+    }
+}
+
+static void check_memchr(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t align = 0; align < 8; align++) {
+            for (size_t k = 0; k < sizeof(g_check_chars) / sizeof(g_check_chars[0]); k++) {
+                int c = g_check_chars[k];
+                unsigned char *s = g_src + align;
+                check_fill(s, 0, size + CHECK_GUARD, c);
+                s[size] = (unsigned char)c;
+                // pos == size has no match within the size, only right after it
+                for (size_t pos = 0; pos <= size; pos++) {
+                    if (!check_position(size, pos)) continue;
+                    if (pos < size) s[pos] = (unsigned char)c;
+                    // the upper bits of c are ignored
+                    if (memchr(s, c + 0x100, size) != ref_memchr(s, c, size)) {
+                        check_fail("memchr", size, align, (size_t)c, pos);
+                    }
+                    check_restore(s, size, pos, c);
+                }
+            }
+        }
+    }
+}
+
+static void check_strchr(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t align = 0; align < 8; align++) {
+            for (size_t k = 0; k < sizeof(g_check_chars) / sizeof(g_check_chars[0]); k++) {
+                int c = g_check_chars[k];
+                unsigned char *s = g_src + align;
+                check_fill(s, 0, size + CHECK_GUARD, c);
+                s[size] = 0;
+                s[size + 1] = (unsigned char)c;
+                // pos == size leaves c only after the terminating zero
+                for (size_t pos = 0; pos <= size; pos++) {
+                    if (!check_position(size, pos)) continue;
+                    if (pos < size) s[pos] = (unsigned char)c;
+                    if ((unsigned char *)strchr((char *)s, c) != ref_strchr(s, c)) {
+                        check_fail("strchr", size, align, (size_t)c, pos);
+                    }
+                    check_restore(s, size, pos, c);
+                }
+            }
+        }
+    }
+}
+
+// Makes l and r differ first at pos, with the sign given by l_greater, and
+// then the other way round right after it. A comparison that orders whole
+// little-endian words without reversing their bytes gets the sign wrong.
+static void check_set_difference(unsigned char *l, unsigned char *r, size_t size, size_t pos, bool l_greater) {
+    unsigned char big = 0x80, small = 0x7f;
+    l[pos] = l_greater ? big : small;
+    r[pos] = l_greater ? small : big;
+    if (pos + 1 < size) {
+        l[pos + 1] = l_greater ? small : big;
+        r[pos + 1] = l_greater ? big : small;
+    }
+}
+
+static void check_memcmp(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t l_align = 0; l_align < 8; l_align++) {
+            for (size_t r_align = 0; r_align < 8; r_align++) {
+                unsigned char *l = g_src + l_align, *r = g_dst + r_align;
+                check_fill(l, 0, size + CHECK_GUARD, 0);
+                check_fill(r, 0, size + CHECK_GUARD, 0);
+                l[size] = 1;
+                r[size] = 2;
+                // pos == size compares equal, with a difference right after
+                for (size_t pos = 0; pos <= size; pos++) {
+                    if (!check_position(size, pos)) continue;
+                    for (int l_greater = 0; l_greater < 2; l_greater++) {
+                        if (pos < size) check_set_difference(l, r, size, pos, l_greater);
+                        if (sign(memcmp(l, r, size)) != ref_memcmp(l, r, size)) {
+                            check_fail("memcmp", size, l_align, r_align, pos);
+                        }
+                        check_restore(l, size, pos, 0);
+                        check_restore(r, size, pos, 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void check_strcmp(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t l_align = 0; l_align < 8; l_align++) {
+            for (size_t r_align = 0; r_align < 8; r_align++) {
+                unsigned char *l = g_src + l_align, *r = g_dst + r_align;
+                check_fill(l, 0, size + CHECK_GUARD, 0);
+                check_fill(r, 0, size + CHECK_GUARD, 0);
+                l[size] = r[size] = 0;
+                l[size + 1] = 1;
+                r[size + 1] = 2;
+                // pos == size compares equal, with a difference after the zero
+                for (size_t pos = 0; pos <= size; pos++) {
+                    if (!check_position(size, pos)) continue;
+                    // a difference at pos, or one string ending there
+                    for (int kind = 0; kind < 4; kind++) {
+                        if (pos < size) {
+                            if (kind < 2) {
+                                check_set_difference(l, r, size, pos, kind);
+                            } else {
+                                (kind == 2 ? l : r)[pos] = 0;
+                            }
+                        }
+                        if (sign(strcmp((char *)l, (char *)r)) != ref_strcmp(l, r)) {
+                            check_fail("strcmp", size, l_align, r_align, pos);
+                        }
+                        check_restore(l, size, pos, 0);
+                        check_restore(r, size, pos, 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void check_memcpy(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t src_align = 0; src_align < 8; src_align++) {
+            for (size_t dst_align = 0; dst_align < 8; dst_align++) {
+                size_t len = dst_align + size + CHECK_GUARD;
+                check_fill(g_src, 0, src_align + size + CHECK_GUARD, 0);
+                for (size_t j = 0; j < len; j++) g_dst[j] = 0xee;
+                if (memcpy(g_dst + dst_align, g_src + src_align, size) != g_dst + dst_align) {
+                    check_fail("memcpy", size, src_align, dst_align, 0);
+                }
+                for (size_t j = 0; j < len; j++) {
+                    bool copied = j >= dst_align && j < dst_align + size;
+                    if (g_dst[j] != (copied ? g_src[src_align + j - dst_align] : 0xee)) {
+                        check_fail("memcpy", size, src_align, dst_align, j);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void check_memset(void) {
+    for (size_t i = 0; i < CHECK_SIZE_COUNT; i++) {
+        size_t size = check_size(i);
+        for (size_t align = 0; align < 8; align++) {
+            for (size_t k = 0; k < sizeof(g_check_chars) / sizeof(g_check_chars[0]); k++) {
+                int c = g_check_chars[k];
+                size_t len = align + size + CHECK_GUARD;
+                for (size_t j = 0; j < len; j++) g_dst[j] = 0xee;
+                // the upper bits of c are ignored
+                if (memset(g_dst + align, c + 0x100, size) != g_dst + align) {
+                    check_fail("memset", size, align, (size_t)c, 0);
+                }
+                for (size_t j = 0; j < len; j++) {
+                    bool set = j >= align && j < align + size;
+                    if (g_dst[j] != (set ? (unsigned char)c : 0xee)) {
+                        check_fail("memset", size, align, (size_t)c, j);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static const struct {
+    const char *name;
+    size_t (*run)(size_t size, size_t align);
+} g_benches[] = {
+    {"strlen", bench_strlen}, {"memchr", bench_memchr}, {"memcmp", bench_memcmp},
+    {"strcmp", bench_strcmp}, {"memcpy", bench_memcpy}, {"memset", bench_memset},
+};
+
+int main(int argc, char *argv[]) {
+    check_strlen();
+    check_memchr();
+    check_strchr();
+    check_memcmp();
+    check_strcmp();
+    check_memcpy();
+    check_memset();
+    if (g_failures) {
+        printf("%d string function mismatches\n", g_failures);
+        return 1;
+    }
+    for (size_t b = 0; b < sizeof(g_benches) / sizeof(g_benches[0]); b++) {
+        for (size_t i = 0; i < sizeof(g_sizes) / sizeof(g_sizes[0]); i++) {
+            for (size_t j = 0; j < sizeof(g_aligns) / sizeof(g_aligns[0]); j++) {
+                size_t size = g_sizes[i], align = g_aligns[j];
+                bench_setup(size, align);
+                uint64_t start = ckb_current_cycles();
+                for (int r = 0; r < BENCH_ROUNDS; r++) {
+                    g_sink += g_benches[b].run(size, align);
+                }
+                uint64_t cycles = ckb_current_cycles() - start;
+                // Hundredths of a cycle per byte
+                uint64_t per_byte = cycles * 100 / (BENCH_ROUNDS * size);
+                printf("%s size=%d align=%d cycles/byte=%d.%02d\n", g_benches[b].name, (int)size, (int)align,
+                       (int)(per_byte / 100), (int)(per_byte % 100));
+            }
+        }
+    }
+    return 0;
+}
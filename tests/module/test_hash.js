@@ -335,6 +335,103 @@ function test_ripemd160_long_string() {
     console.log('test_ripemd160_long_string ok');
 }
 
+function test_multi_buffer_update() {
+    // "hello" from views, arrays and variadic arguments in one call each
+    const expected =
+        '2da1289373a9f6b7ed21db948f4dc5d942cf4023eaef1d5a2b1a45b9d12d1036';
+    const padded = hexStringToUint8Array('ff68656c6c6fff');
+    const view = padded.subarray(1, 6);
+
+    let blake2b = new hash.Blake2b(CKB_DEFAULT_HASH);
+    blake2b.update(view);
+    console.assert(
+        arrayBufferToHexString(blake2b.finalize()) === expected,
+        'Typed array view hash failed');
+
+    blake2b = new hash.Blake2b(CKB_DEFAULT_HASH);
+    const start = ckb.currentCycles();
+    blake2b.update(padded.subarray(1, 2), [padded.subarray(2, 4), padded.subarray(4, 6)]);
+    const end = ckb.currentCycles();
+    console.log(`multi-buffer update cycles: ${end - start}`);
+    console.assert(
+        arrayBufferToHexString(blake2b.finalize()) === expected,
+        'Multi-buffer hash failed');
+
+    const sha256 = new hash.Sha256();
+    sha256.update([hexStringToUint8Array('68656c').buffer, hexStringToUint8Array('6c6f')]);
+    console.assert(
+        arrayBufferToHexString(sha256.finalize()) ===
+            '2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824',
+        'Array update hash failed');
+
+    let success = false;
+    try {
+        new hash.Sha256().update();
+    } catch (e) {
+        success = e instanceof TypeError;
+    }
+    console.assert(success, 'update() without data should throw a TypeError');
+
+    // an invalid item rejects the whole call before anything is hashed
+    const partial = new hash.Sha256();
+    success = false;
+    try {
+        partial.update(hexStringToUint8Array('68656c'), [hexStringToUint8Array('6c6f'), 42]);
+    } catch (e) {
+        success = e instanceof TypeError;
+    }
+    console.assert(success, 'update() with an invalid item should throw a TypeError');
+    partial.update(hexStringToUint8Array('68656c6c6f'));
+    console.assert(
+        arrayBufferToHexString(partial.finalize()) ===
+            '2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824',
+        'Rejected update should leave the state unchanged');
+    console.log('test_multi_buffer_update ok');
+}
+
+function test_one_shot() {
+    const input = hexStringToUint8Array('68656c6c6f');  // "hello" in hex
+    let start = ckb.currentCycles();
+    let result = hash.sha256(input.buffer);
+    let end = ckb.currentCycles();
+    console.log(`one-shot sha256 cycles: ${end - start}`);
+    console.assert(
+        arrayBufferToHexString(result) ===
+            '2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824',
+        'One-shot sha256 failed');
+    result = hash.keccak256(input.buffer);
+    console.assert(
+        arrayBufferToHexString(result) ===
+            '1c8aff950685c2ed4bc3174f3472287b56d9517b9c948127319a09a7a36deac8',
+        'One-shot keccak256 failed');
+    result = hash.ripemd160(input.buffer);
+    console.assert(
+        arrayBufferToHexString(result) === '108f07b8382412612c048d07d13f814118445acd',
+        'One-shot ripemd160 failed');
+    start = ckb.currentCycles();
+    result = hash.blake2b256(input.buffer);
+    end = ckb.currentCycles();
+    console.log(`one-shot blake2b256 cycles: ${end - start}`);
+    console.assert(
+        arrayBufferToHexString(result) ===
+            '2da1289373a9f6b7ed21db948f4dc5d942cf4023eaef1d5a2b1a45b9d12d1036',
+        'One-shot blake2b256 failed');
+    result = hash.blake2b256(new Uint8Array(0).buffer, CKB_DEFAULT_HASH);
+    console.assert(
+        arrayBufferToHexString(result) ===
+            '44f4c69744d5f8c55d642062949dcae49bc4e7ef43d388c5a12f42b5633d163e',
+        'One-shot blake2b256 with personal failed');
+
+    let success = false;
+    try {
+        hash.blake2b256(input.buffer, 'short');
+    } catch (e) {
+        success = true;
+    }
+    console.assert(success, 'One-shot blake2b256 personal check failed');
+    console.log('test_one_shot ok');
+}
+
 console.log('test_hash.js ...');
 test_sha2_sha256_empty_string();
 test_sha2_sha256_basic_string();
@@ -353,4 +450,6 @@ test_ripemd160_empty_string();
 test_ripemd160_basic_string();
 test_ripemd160_multiple_updates();
 test_ripemd160_long_string();
+test_multi_buffer_update();
+test_one_shot();
 console.log('test_hash.js ok');
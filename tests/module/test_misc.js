@@ -183,6 +183,31 @@ function test_base64_decode2() {
     console.log('test_base64_decode2 ok');
 }
 
+function test_byte_views() {
+    // "Hello World!" surrounded by two bytes on each side
+    const buffer = misc.hex.decode('ffff48656c6c6f20576f726c6421ffff');
+    const bytes = new Uint8Array(buffer, 2, 12);
+    const view = new DataView(buffer, 2, 12);
+
+    console.assert(misc.hex.encode(bytes) === '48656c6c6f20576f726c6421', 'hex encode of Uint8Array failed');
+    console.assert(misc.hex.encode(view) === '48656c6c6f20576f726c6421', 'hex encode of DataView failed');
+    console.assert(misc.base64.encode(view) === 'SGVsbG8gV29ybGQh', 'base64 encode of DataView failed');
+    console.assert(misc.base64.encode(new Uint32Array(buffer, 4, 2)) === 'bGxvIFdvcmw=', 'base64 encode of Uint32Array failed');
+
+    const decoder = new misc.TextDecoder();
+    console.assert(decoder.decode(bytes) === 'Hello World!', 'TextDecoder of Uint8Array failed');
+    console.assert(decoder.decode(view) === 'Hello World!', 'TextDecoder of DataView failed');
+    console.assert(decoder.decode(buffer.slice(2, 7)) === 'Hello', 'TextDecoder of ArrayBuffer failed');
+
+    let success = false;
+    try {
+        misc.hex.encode('48656c6c6f');
+    } catch (e) {
+        success = true;
+    }
+    console.assert(success, 'hex encode should reject a string');
+    console.log('test_byte_views ok');
+}
 
 function test_import_meta() {
     console.assert(import.meta.main, 'import.meta.main should be true');
@@ -200,15 +225,44 @@ function test_printf() {
     console.log('test_printf ok');
 }
 
+function test_memory_stats() {
+    const before = misc.memoryStats();
+    const data = [];
+    for (let i = 0; i < 1000; i++) {
+        data.push({ i, s: 'item' + i });
+    }
+    // larger than any free block left in the heap, so the break has to grow
+    const big = new Uint8Array(512 * 1024);
+    const after = misc.memoryStats();
+    console.assert(before.reservedBytes > 0 && before.reservedBytes < before.brkUsed, 'reservedBytes failed');
+    console.assert(after.brkUsed >= before.brkUsed + big.length, 'brkUsed should grow with a large buffer');
+    // only counted by MEMORY_USAGE builds
+    if (before.liveBytes > 0) {
+        console.assert(after.liveBytes >= before.liveBytes + big.length, 'liveBytes should grow with a large buffer');
+        console.assert(after.peakLiveBytes >= after.liveBytes, 'peakLiveBytes failed');
+    }
+    console.assert(after.reallocsInPlace <= after.reallocs, 'reallocsInPlace failed');
+    console.assert(after.allocsBySize.length === 12, 'allocsBySize failed');
+    console.log('test_memory_stats ok', data.length);
+}
+
 function test_require() {
     const ckb = require('@ckb-js-std/bindings');
     console.assert(typeof ckb.loadScript === 'function', 'require failed');
     console.assert(ckb.currentCycles() > 0, 'currentCycles failed');
+    console.assert(require('@ckb-js-std/bindings') === ckb, 'require should return the same namespace');
+    console.assert(globalThis.__ckb_module === ckb, '__ckb_module failed');
+    const desc = Object.getOwnPropertyDescriptor(globalThis, '__ckb_module');
+    console.assert(desc.writable && desc.configurable, '__ckb_module should be a writable value property');
+    globalThis.__ckb_module = 1;
+    console.assert(globalThis.__ckb_module === 1, '__ckb_module should be writable');
+    globalThis.__ckb_module = ckb;
     let success = false;
     try {
         const ckb = require("not existing module");
     } catch (e) {
-        success = true;
+        success = e instanceof Error && !(e instanceof ReferenceError) &&
+            e.message === 'cannot find the module: not existing module';
     }
     console.assert(success, 'require should throw error');
 }
@@ -251,5 +305,7 @@ test_ckb_smt_verify_invalid();
 test_base64_encode();
 test_base64_decode();
 test_base64_decode2();
+test_byte_views();
 test_import_meta();
+test_memory_stats();
 console.log('test_misc.js ok');
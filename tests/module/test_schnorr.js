@@ -72,10 +72,123 @@ function test_invalid_signature() {
     console.log('test_invalid_signature ok');
 }
 
+function test_verify_batch() {
+    const sig = new Uint8Array(misc.hex.decode(
+        '52420fa2807eac7336c15ec7db76b41c3247f8457a1533bd783378e563cb33c43e5a8b17e91badaa290c02d3f8ce50df130c9d09c90c288d9d2be0e5976a5354'));
+    const msg = misc.hex.decode(
+        '1bd69c075dd7b78c4f20a698b22a3fb9d7461525c39827d6aaf7a1628be0a283');
+    const xonlyPubkey = new Uint8Array(schnorr.parseXonlyPubkey(misc.hex.decode(
+        '2504ea5763b6d7a51b50dbf5871e50f195b3e0297fe6272334be555d3e5231a6')));
+    const n = 10;
+    const sigs = new Uint8Array(n * 64);
+    const pubkeys = new Uint8Array(n * 64);
+    for (let i = 0; i < n; i++) {
+        sigs.set(sig, i * 64);
+        pubkeys.set(xonlyPubkey, i * 64);
+    }
+
+    let start = ckb.currentCycles();
+    let bitmap = new Uint8Array(schnorr.verifyBatch(sigs, msg, pubkeys));
+    let end = ckb.currentCycles();
+    console.log(`verifyBatch cycles (${n} signatures): ${end - start}`);
+    console.assert(bitmap[0] === 0xff && bitmap[1] === 0x03, 'verifyBatch of valid signatures failed');
+
+    // One broken signature makes the combined check fail, the fallback finds it
+    sigs[5 * 64 + 40] ^= 1;
+    bitmap = new Uint8Array(schnorr.verifyBatch(sigs, msg, pubkeys));
+    console.assert(bitmap[0] === 0xdf && bitmap[1] === 0x03, 'verifyBatch should find the invalid signature');
+
+    const msgs = new Uint8Array(n * 32);
+    for (let i = 0; i < n; i++) {
+        msgs.set(new Uint8Array(msg), i * 32);
+    }
+    msgs[0] ^= 1;
+    bitmap = new Uint8Array(schnorr.verifyBatch(sigs, msgs, pubkeys));
+    console.assert(bitmap[0] === 0xde && bitmap[1] === 0x03, 'verifyBatch with one message per signature failed');
+
+    let success = false;
+    try {
+        schnorr.verifyBatch(sigs, msgs.subarray(0, 64), pubkeys);
+    } catch (e) {
+        success = true;
+    }
+    console.assert(success, 'verifyBatch should check the number of messages');
+    console.log('test_verify_batch ok');
+}
+
+// Packs [pubkey, message, signature] hex triples for verifyBatch, the messages
+// one per signature
+function pack_batch(vectors) {
+    const n = vectors.length;
+    const sigs = new Uint8Array(n * 64);
+    const msgs = new Uint8Array(n * 32);
+    const pubkeys = new Uint8Array(n * 64);
+    vectors.forEach(([pubkey, msg, sig], i) => {
+        pubkeys.set(new Uint8Array(schnorr.parseXonlyPubkey(misc.hex.decode(pubkey))), i * 64);
+        msgs.set(new Uint8Array(misc.hex.decode(msg)), i * 32);
+        sigs.set(new Uint8Array(misc.hex.decode(sig)), i * 64);
+    });
+    return { sigs, msgs, pubkeys };
+}
+
+function test_verify_batch_distinct() {
+    // BIP340 test vectors 0 to 4: different keys, messages and signatures
+    const vectors = [
+        ['f9308a019258c31049344f85f89d5229b531c845836f99b08601f113bce036f9',
+            '0000000000000000000000000000000000000000000000000000000000000000',
+            'e907831f80848d1069a5371b402410364bdf1c5f8307b0084c55f1ce2dca821525f66a4a85ea8b71e482a74f382d2ce5ebeee8fdb2172f477df4900d310536c0'],
+        ['dff1d77f2a671c5f36183726db2341be58feae1da2deced843240f7b502ba659',
+            '243f6a8885a308d313198a2e03707344a4093822299f31d0082efa98ec4e6c89',
+            '6896bd60eeae296db48a229ff71dfe071bde413e6d43f917dc8dcf8c78de33418906d11ac976abccb20b091292bff4ea897efcb639ea871cfa95f6de339e4b0a'],
+        ['dd308afec5777e13121fa72b9cc1b7cc0139715309b086c960e18fd969774eb8',
+            '7e2d58d8b3bcdf1abadec7829054f90dda9805aab56c77333024b9d0a508b75c',
+            '5831aaeed7b44bb74e5eab94ba9d4294c49bcf2a60728d8b4c200f50dd313c1bab745879a5ad954a72c45a91c3a51d3c7adea98d82f8481e0e1e03674a6f3fb7'],
+        ['25d1dff95105f5253c4022f628a996ad3a0d95fbf21d468a1b33f8c160d8f517',
+            'ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff',
+            '7eb0509757e246f19449885651611cb965ecc1a187dd51b64fda1edc9637d5ec97582b9cb13db3933705b32ba982af5af25fd78881ebb32771fc5922efc66ea3'],
+        ['d69c3509bb99e412e68b0fe8544e72837dfa30746d8be2aa65975f29d22dc7b9',
+            '4df3c3f68fcc83b27e9d42c90431a72499f17875c81a599b566c9889b9696703',
+            '00000000000000000000003b78ce563f89a0ed9414f5aa28ad0d96d6795f9c6376afb1548af603b3eb45c9f8207dee1060cb71c04e80f593060b07d28308d7f4'],
+    ];
+    const { sigs, msgs, pubkeys } = pack_batch(vectors);
+    let bitmap = new Uint8Array(schnorr.verifyBatch(sigs, msgs, pubkeys));
+    console.assert(bitmap.length === 1 && bitmap[0] === 0x1f, 'verifyBatch of distinct valid signatures failed');
+
+    // Swapping two messages breaks exactly those two signatures
+    const swapped = new Uint8Array(msgs);
+    swapped.set(msgs.subarray(32, 64), 64);
+    swapped.set(msgs.subarray(64, 96), 32);
+    bitmap = new Uint8Array(schnorr.verifyBatch(sigs, swapped, pubkeys));
+    console.assert(bitmap[0] === 0x19, 'verifyBatch should reject swapped messages');
+
+    // One message signed by different keys, passed once for the whole batch
+    const msg = '1bd69c075dd7b78c4f20a698b22a3fb9d7461525c39827d6aaf7a1628be0a283';
+    const shared = pack_batch([
+        ['2504ea5763b6d7a51b50dbf5871e50f195b3e0297fe6272334be555d3e5231a6', msg,
+            '52420fa2807eac7336c15ec7db76b41c3247f8457a1533bd783378e563cb33c43e5a8b17e91badaa290c02d3f8ce50df130c9d09c90c288d9d2be0e5976a5354'],
+        ['f9308a019258c31049344f85f89d5229b531c845836f99b08601f113bce036f9', msg,
+            '9ba2731c38a07ea98edd70fc4db7ce3ccac921d9fc71d278eb3c2f0aaa23f232eda9743e7863621fb57b35efcc7cc2db0f3552ab0e5fbc0bc4cf8d6fecc6d834'],
+        ['dff1d77f2a671c5f36183726db2341be58feae1da2deced843240f7b502ba659', msg,
+            '67853ee6f6c39a09b622b0d466398c9676eb86be806ec45a5abf0efe69c1cc68d190cbb839dc2b86262f7457fccca005ca32b776139a887b3ff8a716e4d82ba7'],
+    ]);
+    bitmap = new Uint8Array(schnorr.verifyBatch(shared.sigs, misc.hex.decode(msg), shared.pubkeys));
+    console.assert(bitmap[0] === 0x07, 'verifyBatch of one message under different keys failed');
+
+    // Signatures paired with the wrong keys all fail
+    const rotated = new Uint8Array(shared.pubkeys.length);
+    rotated.set(shared.pubkeys.subarray(64), 0);
+    rotated.set(shared.pubkeys.subarray(0, 64), 128);
+    bitmap = new Uint8Array(schnorr.verifyBatch(shared.sigs, misc.hex.decode(msg), rotated));
+    console.assert(bitmap[0] === 0x00, 'verifyBatch should reject signatures under the wrong keys');
+    console.log('test_verify_batch_distinct ok');
+}
+
 console.log('test_schnorr.js ...');
 test_verify();
 test_pubkey();
 test_tagged_sha256();
 test_invalid_pubkey();
 test_invalid_signature();
+test_verify_batch();
+test_verify_batch_distinct();
 console.log('test_schnorr.js ok');
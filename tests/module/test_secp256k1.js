@@ -144,6 +144,68 @@ function test_serialize_pubkey() {
     console.log('test_serialize_pubkey ok');
 }
 
+function test_batch() {
+    const sig = misc.hex.decode(
+        '76e6d0e5ea61b46fe10443fe5b4d1bc6' +
+        'ce2d0d49d55e810312f7c22702e0548a' +
+        '3969ce72940a34632f93ebd1b8d591c3' +
+        '775428f035c6577e4adf8068b04819f0');
+    const msg = misc.hex.decode(
+        '6a0024347e28905e2587c4c7598332a39' +
+        'ba6684bb6b74653511656a02bd20edb');
+    const pubkey = misc.hex.decode(
+        'aca98c5822b997c15f8c974386a11b14' +
+        'a0d009a4d5156e145644573e82ef7e7b' +
+        '226b9eb6173d6b4504606eb8d9558bde' +
+        '98d12100836e92d306a40f337ed8a0f3');
+    const zeros = new Uint8Array(64);
+    const n = 9;
+
+    // Every third signature is broken
+    const sigs = new Uint8Array(n * 64);
+    const pubkeys = new Uint8Array(n * 64);
+    const recoverable = new Uint8Array(n * 65);
+    for (let i = 0; i < n; i++) {
+        sigs.set(i % 3 === 2 ? zeros : new Uint8Array(sig), i * 64);
+        pubkeys.set(new Uint8Array(pubkey), i * 64);
+        recoverable.set(new Uint8Array(sig), i * 65);
+        recoverable[i * 65 + 64] = i % 3 === 2 ? 4 : 1;
+    }
+
+    let start = ckb.currentCycles();
+    const bitmap = new Uint8Array(secp256k1.verifyBatch(sigs, msg, pubkeys));
+    let end = ckb.currentCycles();
+    console.log(`verifyBatch cycles (${n} signatures): ${end - start}`);
+    console.assert(bitmap.length === 2, 'verifyBatch bitmap length');
+    console.assert(bitmap[0] === 0xdb && bitmap[1] === 0x01, 'verifyBatch bitmap');
+
+    const msgs = new Uint8Array(n * 32);
+    for (let i = 0; i < n; i++) {
+        msgs.set(new Uint8Array(msg), i * 32);
+    }
+    start = ckb.currentCycles();
+    const recovered = new Uint8Array(secp256k1.recoverBatch(recoverable, msgs));
+    end = ckb.currentCycles();
+    console.log(`recoverBatch cycles (${n} signatures): ${end - start}`);
+    for (let i = 0; i < n; i++) {
+        const expected = i % 3 === 2 ? misc.hex.encode(zeros) : misc.hex.encode(pubkey);
+        console.assert(
+            misc.hex.encode(recovered.subarray(i * 64, i * 64 + 64)) === expected,
+            `recoverBatch public key ${i}`);
+    }
+
+    console.assert(secp256k1.verifyBatch(new ArrayBuffer(0), msg, new ArrayBuffer(0)).byteLength === 0,
+        'verifyBatch of nothing');
+    let success = false;
+    try {
+        secp256k1.verifyBatch(sigs, msg, pubkey);
+    } catch (e) {
+        success = true;
+    }
+    console.assert(success, 'verifyBatch should check the number of public keys');
+    console.log('test_batch ok');
+}
+
 function test_func_not_found() {
     let success = false;
     try {
@@ -162,5 +224,6 @@ test_recovery_failure();
 test_verify();
 test_parse_pubkey();
 test_serialize_pubkey();
+test_batch();
 test_func_not_found();
 console.log('test_secp256k1.js ok');
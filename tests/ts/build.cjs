@@ -35,14 +35,39 @@ function compileBc(jsFile, bcFile) {
   }
 }
 
-function packFileSystem(files, outputPath) {
+// Same as compileBc, with a snapshot (-s) instead of plain bytecode
+function compileSnapshot(jsFile, snapFile) {
+  if (!snapFile) {
+    snapFile = jsFile.replace(".js", ".snap");
+    snapFile = snapFile.replace("src", "dist");
+  }
+
+  const snapDir = path.dirname(snapFile);
+  if (!fs.existsSync(snapDir)) {
+    fs.mkdirSync(snapDir, { recursive: true });
+  }
+
+  const jsVmPath = path.resolve(__dirname, "../../build/ckb-js-vm");
+
+  const command = `ckb-debugger --read-file ${jsFile} --bin ${jsVmPath} -- -s ${snapFile}`;
+
+  try {
+    execSync(command, { stdio: "inherit" });
+  } catch (error) {
+    console.error("Error building snapshot file:", error.message);
+    process.exit(1);
+  }
+}
+
+function packFileSystem(files, outputPath, options = {}) {
   try {
     check();
     const dir = path.dirname(outputPath);
     if (!fs.existsSync(dir)) {
       fs.mkdirSync(dir, { recursive: true });
     }
-    const command = `node "${CKB_FS_PACKER}" pack ${outputPath} ${files.join(" ")}`;
+    const flags = options.compress ? "--compress " : "";
+    const command = `node "${CKB_FS_PACKER}" pack ${flags}${outputPath} ${files.join(" ")}`;
     execSync(command, { stdio: "inherit" });
   } catch (error) {
     console.error("Error building file system:", error.message);
@@ -103,4 +128,4 @@ function bundleCode(inputFile, outputFile) {
   }
 }
 
-module.exports = { compileBc, check, packFileSystem, typeCheck, bundleCode };
+module.exports = { compileBc, compileSnapshot, check, packFileSystem, typeCheck, bundleCode };
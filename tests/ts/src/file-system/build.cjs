@@ -1,13 +1,19 @@
-const { compileBc, packFileSystem } = require("../../build.cjs");
+const fs = require("fs");
+const path = require("path");
+const { compileBc, compileSnapshot, packFileSystem } = require("../../build.cjs");
 
 const OUTPUT_FS = "dist/file-system/fs.bin";
 const OUTPUT_FS_2 = "dist/file-system/fs2.bin";
 const OUTPUT_FS_BC = "dist/file-system/fs-bc.bin";
+const OUTPUT_FS_SNAPSHOT = "dist/file-system/fs-snapshot.bin";
+const OUTPUT_FS_COMPRESSED = "dist/file-system/fs-compressed.bin";
 
 module.exports = {
   OUTPUT_FS,
   OUTPUT_FS_2,
   OUTPUT_FS_BC,
+  OUTPUT_FS_SNAPSHOT,
+  OUTPUT_FS_COMPRESSED,
 };
 
 function buildFileSystem() {
@@ -41,6 +47,57 @@ function buildFileSystem2() {
   packFileSystem(files, OUTPUT_FS_2);
 }
 
+// Snapshots are mapped in place from the code cell, and fib_module.bc is read
+// twice: as itself and as the fallback of fib_module.js.
+function buildFileSystemSnapshot() {
+  compileSnapshot("src/file-system/data/fib_module.js");
+  compileSnapshot("src/file-system/data/index_snapshot.js");
+
+  const files = [
+    "dist/file-system/data/fib_module.snap:fib_module.bc",
+    "dist/file-system/data/index_snapshot.snap:index.bc",
+  ];
+  packFileSystem(files, OUTPUT_FS_SNAPSHOT);
+}
+
+// A module over 64 KB, so that its LZ4 block has literal runs and matches
+// longer than 255 bytes: pseudo-random text and a repeated fill.
+function generateLargeModule(outputPath) {
+  let seed = 12345;
+  let text = "";
+  let checksum = 0;
+  const alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+  for (let i = 0; i < 40000; i++) {
+    seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+    const c = alphabet[(seed >>> 16) % alphabet.length];
+    text += c;
+    checksum = (checksum * 31 + c.charCodeAt(0)) % 2147483647;
+  }
+  const fill = "0123456789".repeat(3000);
+  fs.mkdirSync(path.dirname(outputPath), { recursive: true });
+  fs.writeFileSync(
+    outputPath,
+    `export const text = "${text}";\n` +
+      `export const fill = "${fill}";\n` +
+      `export const checksum = ${checksum};\n`,
+  );
+}
+
+// Every file is LZ4 compressed: modules are imported and read by loadFile
+// from decompressed copies.
+function buildFileSystemCompressed() {
+  generateLargeModule("dist/file-system/data/large_module.js");
+
+  const files = [
+    "src/file-system/data/fib_module.js:fib_module.js",
+    "dist/file-system/data/large_module.js:large_module.js",
+    "src/file-system/data/index_compressed.js:index.js",
+  ];
+  packFileSystem(files, OUTPUT_FS_COMPRESSED, { compress: true });
+}
+
 buildFileSystem();
 buildFileSystem2();
 buildFileSystemBc();
+buildFileSystemSnapshot();
+buildFileSystemCompressed();
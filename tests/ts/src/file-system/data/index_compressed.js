@@ -0,0 +1,20 @@
+/* example of modules and files from an LZ4 compressed file system */
+import * as ckb from "@ckb-js-std/bindings";
+import * as module from "./fib_module.js";
+import { text, fill, checksum } from "./large_module.js";
+
+console.assert(module.fib(10) == 55, "fib(10) != 55");
+
+// large_module.js is over 64 KB: long literal runs in `text`, long matches in `fill`
+let sum = 0;
+for (let i = 0; i < text.length; i++) {
+  sum = (sum * 31 + text.charCodeAt(i)) % 2147483647;
+}
+console.assert(sum == checksum, "large module checksum mismatch");
+console.assert(fill == "0123456789".repeat(fill.length / 10), "large module fill mismatch");
+
+const code = ckb.loadFile("large_module.js");
+console.assert(code.length > 65536, "load large file failed");
+console.assert(code.includes(text) && code.includes(fill), "load large file content mismatch");
+console.assert(ckb.loadFile("fib_module.js").includes("function fib"), "load file failed");
+console.log("compressed version, done");
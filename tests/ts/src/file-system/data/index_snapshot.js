@@ -0,0 +1,8 @@
+/* example of snapshot modules */
+import * as module from "./fib_module.bc";
+// fib_module.js falls back to fib_module.bc: the same snapshot, read again
+import * as module_js from "./fib_module.js";
+
+console.assert(module.fib(10) == 55, "fib(10) != 55");
+console.assert(module_js.fib(10) == 55, "fib(10) != 55");
+console.log("snapshot version, done");
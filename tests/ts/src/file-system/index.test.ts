@@ -6,7 +6,7 @@ import {
   DEFAULT_SCRIPT_ALWAYS_SUCCESS,
 } from "ckb-testtool";
 
-import { OUTPUT_FS, OUTPUT_FS_2, OUTPUT_FS_BC } from "./build.cjs";
+import { OUTPUT_FS, OUTPUT_FS_2, OUTPUT_FS_BC, OUTPUT_FS_SNAPSHOT, OUTPUT_FS_COMPRESSED } from "./build.cjs";
 
 async function runFileSystem(path: string) {
   const resource = Resource.default();
@@ -56,7 +56,13 @@ describe("file system", () => {
   test("bytecode success", () => {
     runFileSystem(OUTPUT_FS_BC);
   });
+  test("snapshot read twice success", () => {
+    runFileSystem(OUTPUT_FS_SNAPSHOT);
+  });
   test("loadJsScript/loadFile success", () => {
     runFileSystem(OUTPUT_FS_2);
   });
+  test("compressed modules/loadFile success", () => {
+    runFileSystem(OUTPUT_FS_COMPRESSED);
+  });
 });
@@ -100,6 +100,147 @@ function test_partial_loading_field_without_comparing(load_func, field) {
   console.log("test_partial_loading_field_without_comparing done");
 }
 
+function test_load_into(load_into) {
+  console.log("test_load_into ...");
+  let buf = new ArrayBuffer(16);
+  let length = load_into(buf, 0, 0, ckb.SOURCE_OUTPUT);
+  console.assert(length === 8, "length != 8");
+  expect_array(new Uint8Array(buf, 0, length), ARRAY8);
+  // truncated: only the space left in the buffer is written
+  let small = new Uint8Array(6);
+  length = load_into(small, 2, 0, ckb.SOURCE_OUTPUT, 1);
+  console.assert(length === 7, "length != 7");
+  expect_array(small.subarray(2), ARRAY8.slice(1, 5));
+  // typed array views write within their own window
+  let view = new Uint8Array(buf, 8, 8);
+  length = load_into(view, 0, 0, ckb.SOURCE_OUTPUT);
+  console.assert(length === 8, "length != 8");
+  expect_array(new Uint8Array(buf, 8, 8), ARRAY8);
+
+  must_throw_exception(() => {
+    load_into(buf, 17, 0, ckb.SOURCE_OUTPUT);
+  });
+  let error_code = must_throw_exception(() => {
+    load_into(buf, 0, 1001, ckb.SOURCE_OUTPUT);
+  });
+  // CKB_INDEX_OUT_OF_BOUND
+  console.assert(error_code === 1, "error_code != 1");
+  // the buffer gives the length, a length argument is rejected
+  let error = null;
+  try {
+    load_into(buf, 0, 0, ckb.SOURCE_OUTPUT, 0, 4);
+  } catch (e) {
+    error = e;
+  }
+  console.assert(error instanceof RangeError, "length argument should throw a RangeError");
+  // argument positions are those of the call
+  error = null;
+  try {
+    load_into(buf, 0, "0", ckb.SOURCE_OUTPUT);
+  } catch (e) {
+    error = e;
+  }
+  console.assert(
+    error instanceof TypeError && error.message.endsWith("at index 2"),
+    "index error should report argument 2",
+  );
+  console.log("test_load_into done");
+}
+
+function test_load_cells_by_field(source, field) {
+  console.log("test_load_cells_by_field ...");
+  let { data, offsets } = ckb.loadCellsByField(source, field);
+  let count = offsets.length - 1;
+  console.assert(count > 0, "no cells loaded");
+  console.assert(offsets[0] === 0, "offsets[0] != 0");
+  console.assert(offsets[count] === data.byteLength, "offsets mismatched");
+  for (let i = 0; i < count; i++) {
+    let expected = ckb.loadCellByField(i, source, field);
+    let item = new Uint8Array(data, offsets[i], offsets[i + 1] - offsets[i]);
+    expect_array(item, new Uint8Array(expected));
+  }
+  must_throw_exception(() => {
+    ckb.loadCellByField(count, source, field);
+  });
+  // start and count
+  let tail = ckb.loadCellsByField(source, field, count - 1, 100);
+  console.assert(tail.offsets.length === 2, "tail.offsets.length != 2");
+  let none = ckb.loadCellsByField(source, field, count);
+  console.assert(none.offsets.length === 1, "none.offsets.length != 1");
+  none = ckb.loadCellsByField(source, field, 0, 0);
+  console.assert(none.data.byteLength === 0, "none.data.byteLength != 0");
+  console.log("test_load_cells_by_field done");
+}
+
+function test_sum_udt_amount() {
+  console.log("test_sum_udt_amount ...");
+  // no cells in the group
+  let sum = ckb.sumUdtAmount(ckb.SOURCE_GROUP_OUTPUT);
+  console.assert(sum === 0n, "sum != 0n");
+  // the output data has only 8 bytes
+  let error_code = must_throw_exception(() => {
+    ckb.sumUdtAmount(ckb.SOURCE_OUTPUT);
+  });
+  console.assert(
+    error_code === ckb.LENGTH_NOT_ENOUGH,
+    "error_code != LENGTH_NOT_ENOUGH",
+  );
+  console.log("test_sum_udt_amount done");
+}
+
+function test_hash_from_syscall() {
+  console.log("test_hash_from_syscall ...");
+  let witness = ckb.loadWitness(0, ckb.SOURCE_OUTPUT);
+  let hasher = new ckb.Blake2b("ckb-default-hash");
+  hasher.update(witness);
+  expect_array(
+    new Uint8Array(ckb.hashWitness(0, ckb.SOURCE_OUTPUT)),
+    new Uint8Array(hasher.finalize()),
+  );
+  hasher = new ckb.Blake2b("ckb-default-hash");
+  hasher.update(ckb.loadCellData(0, ckb.SOURCE_OUTPUT));
+  expect_array(
+    new Uint8Array(ckb.hashCellData(0, ckb.SOURCE_OUTPUT)),
+    new Uint8Array(hasher.finalize()),
+  );
+
+  // partial
+  let expected = new ckb.Sha256();
+  expected.update(witness.slice(1, 5));
+  let sha256 = new ckb.Sha256();
+  let hashed = sha256.updateFromSyscall(
+    ckb.LOAD_WITNESS,
+    0,
+    ckb.SOURCE_OUTPUT,
+    1,
+    4,
+  );
+  console.assert(hashed === 4, "hashed != 4");
+  expect_array(
+    new Uint8Array(sha256.finalize()),
+    new Uint8Array(expected.finalize()),
+  );
+
+  // the transaction takes more than one chunk
+  let tx = ckb.loadTransaction();
+  expected = new ckb.Keccak256();
+  expected.update(tx);
+  let keccak = new ckb.Keccak256();
+  hashed = keccak.updateFromSyscall(ckb.LOAD_TRANSACTION, 0, ckb.SOURCE_INPUT);
+  console.assert(hashed === tx.byteLength, "hashed != tx.byteLength");
+  expect_array(
+    new Uint8Array(keccak.finalize()),
+    new Uint8Array(expected.finalize()),
+  );
+
+  let error_code = must_throw_exception(() => {
+    ckb.hashWitness(1001, ckb.SOURCE_OUTPUT);
+  });
+  // CKB_INDEX_OUT_OF_BOUND
+  console.assert(error_code === 1, "error_code != 1");
+  console.log("test_hash_from_syscall done");
+}
+
 function test_misc() {
   console.log("test_misc ....");
   let hash = ckb.loadTxHash();
@@ -259,6 +400,8 @@ test_partial_loading(ckb.loadWitness);
 test_partial_loading(ckb.loadCellData);
 test_partial_loading_without_comparing(ckb.loadWitness);
 test_partial_loading_without_comparing(ckb.loadCellData);
+test_load_into(ckb.loadWitnessInto);
+test_load_into(ckb.loadCellDataInto);
 test_partial_loading_without_comparing(ckb.loadCell);
 test_partial_loading_field_without_comparing(
   ckb.loadCellByField,
@@ -269,6 +412,11 @@ test_partial_loading_field_without_comparing(
   ckb.INPUT_FIELD_OUT_POINT,
 );
 test_load_cell_data_bug();
+test_load_cells_by_field(ckb.SOURCE_INPUT, ckb.CELL_FIELD_CAPACITY);
+test_load_cells_by_field(ckb.SOURCE_INPUT, ckb.CELL_FIELD_LOCK);
+test_load_cells_by_field(ckb.SOURCE_OUTPUT, ckb.CELL_FIELD_LOCK_HASH);
+test_sum_udt_amount();
+test_hash_from_syscall();
 
 test_spawn();
 // this test must be at the end